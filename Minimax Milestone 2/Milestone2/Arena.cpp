@@ -0,0 +1,89 @@
+#include <string.h>
+#include "Arena.h"
+#include "MemStats.h"
+#include "MyLib.h"
+
+using namespace std;
+
+thread_local Arena *Arena::mCurrent = NULL;
+
+Arena::Arena() : mNext(NULL), mEnd(NULL), mBlockSize(kFirstBlock),
+ mReserved(0) {
+   memset(mFree, 0, sizeof(mFree));
+}
+
+Arena::~Arena() {
+   Release();
+}
+
+// Reuse a freed piece of the same size if there is one.  Otherwise bump
+// through the newest block, starting a new one, each twice the last up to
+// kMaxBlock, when it runs out.  A piece too big to share a block (such as
+// a hash table's bucket array) gets a block of its own.
+void *Arena::Alloc(size_t size) {
+   Chunk *chunk;
+   char *rtn;
+
+   size = (TMax(size, (size_t)1) + kGrain - 1) & ~(size_t)(kGrain - 1);
+   if (size <= kMaxSmall && (chunk = mFree[size / kGrain])) {
+      mFree[size / kGrain] = chunk->next;
+      return chunk;
+   }
+
+   if (size > mBlockSize / 4)
+      return NewBlock(size);
+
+   if (size > (size_t)(mEnd - mNext)) {
+      mNext = NewBlock(mBlockSize);
+      mEnd = mNext + mBlockSize;
+      mBlockSize = TMin(mBlockSize * 2, (size_t)kMaxBlock);
+   }
+   rtn = mNext;
+   mNext += size;
+   return rtn;
+}
+
+// Large pieces are not reused, but go back with the rest on Release.
+void Arena::Free(void *p, size_t size) {
+   Chunk *chunk = (Chunk *)p;
+
+   size = (TMax(size, (size_t)1) + kGrain - 1) & ~(size_t)(kGrain - 1);
+   if (size <= kMaxSmall) {
+      chunk->next = mFree[size / kGrain];
+      mFree[size / kGrain] = chunk;
+   }
+}
+
+// Newest blocks first, since recent objects are the likeliest to be freed.
+bool Arena::Owns(const void *p) const {
+   vector<Block>::const_reverse_iterator bIter;
+
+   for (bIter = mBlocks.rbegin(); bIter != mBlocks.rend(); bIter++)
+      if ((const char *)p >= bIter->start
+       && (const char *)p < bIter->start + bIter->size)
+         return true;
+   return false;
+}
+
+void Arena::Release() {
+   vector<Block>::iterator bIter;
+
+   for (bIter = mBlocks.begin(); bIter != mBlocks.end(); bIter++) {
+      delete[] bIter->start;
+      MemStats::Free(MemStats::kArena, bIter->size);
+   }
+   mBlocks.clear();
+   memset(mFree, 0, sizeof(mFree));
+   mNext = mEnd = NULL;
+   mBlockSize = kFirstBlock;
+   mReserved = 0;
+}
+
+char *Arena::NewBlock(size_t size) {
+   Block block = {new char[size], size};
+
+   mBlocks.push_back(block);
+   mReserved += size;
+   MemStats::Alloc(MemStats::kArena, size);
+   return block.start;
+}
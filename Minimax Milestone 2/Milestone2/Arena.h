@@ -0,0 +1,124 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <vector>
+
+// A region of memory from which one search's temporary objects are carved,
+// and which is given back to the system all at once when the search ends.
+// Allocation bumps a pointer through large blocks, so it takes no lock and
+// leaves no fragments behind.  Small pieces freed during the search go to
+// free lists by size, and are reused before any new memory is bumped, so
+// that a long search needs no more than its peak live size.
+//
+// Each thread may have a current Arena, set by a Scope.  While one is
+// current, Moves and Keys are allocated from it rather than from their
+// classes' freelists, and a Move or Key deleted while its Arena is current
+// goes back to that Arena.  Objects from an Arena must not be deleted once
+// another Arena, or none, is current; they are reclaimed with the Arena.
+class Arena {
+public:
+   Arena();
+   ~Arena();
+
+   // Return 'size' bytes, aligned for any object the search allocates.
+   void *Alloc(size_t size);
+
+   // Take back 'size' bytes at p, as returned by Alloc(size).
+   void Free(void *p, size_t size);
+
+   // Return true if p lies within memory from this Arena.
+   bool Owns(const void *p) const;
+
+   // Give all memory back at once.  Everything allocated here is then gone.
+   void Release();
+
+   // Bytes now held from the system.
+   size_t GetReserved() const {return mReserved;}
+
+   static Arena *GetCurrent() {return mCurrent;}
+
+   // Allocate from the current Arena, or return NULL if there is none.
+   static void *AllocCurrent(size_t size)
+    {return mCurrent ? mCurrent->Alloc(size) : NULL;}
+
+   // Free p to the current Arena, and return true, if p came from there.
+   static bool FreeCurrent(void *p, size_t size) {
+      if (!mCurrent || !mCurrent->Owns(p))
+         return false;
+      mCurrent->Free(p, size);
+      return true;
+   }
+
+   // Makes an Arena (or, given NULL, none) current for the Scope's lifetime.
+   class Scope {
+   public:
+      Scope(Arena *arena) : mSaved(mCurrent) {mCurrent = arena;}
+      ~Scope() {mCurrent = mSaved;}
+
+   private:
+      Scope(const Scope &);
+      void operator=(const Scope &);
+
+      Arena *mSaved;
+   };
+
+protected:
+   enum {kGrain = 8, kMaxSmall = 512, kFirstBlock = 1 << 16,
+    kMaxBlock = 1 << 24};
+
+   struct Chunk {Chunk *next;};          // A freed small piece
+   struct Block {char *start; size_t size;};
+
+   char *NewBlock(size_t size);
+
+   std::vector<Block> mBlocks;
+   char *mNext, *mEnd;                   // Unused part of the newest block
+   size_t mBlockSize;                    // Size of the next block
+   size_t mReserved;
+   Chunk *mFree[kMaxSmall / kGrain + 1]; // Freed pieces, by size / kGrain
+
+   static thread_local Arena *mCurrent;
+
+private:
+   Arena(const Arena &);
+   void operator=(const Arena &);
+};
+
+// An STL allocator drawing from an Arena, or from the heap if given NULL, so
+// that a container's nodes may live in one search's Arena.
+template <class T>
+class ArenaAllocator {
+public:
+   typedef T value_type;
+
+   ArenaAllocator(Arena *arena = NULL) : mArena(arena) {}
+   template <class U>
+   ArenaAllocator(const ArenaAllocator<U> &src) : mArena(src.GetArena()) {}
+
+   T *allocate(size_t n) {
+      return (T *)(mArena ? mArena->Alloc(n * sizeof(T))
+       : ::operator new(n * sizeof(T)));
+   }
+
+   void deallocate(T *p, size_t n) {
+      if (mArena)
+         mArena->Free(p, n * sizeof(T));
+      else
+         ::operator delete(p);
+   }
+
+   Arena *GetArena() const {return mArena;}
+
+   template <class U>
+   bool operator==(const ArenaAllocator<U> &rhs) const
+    {return mArena == rhs.GetArena();}
+   template <class U>
+   bool operator!=(const ArenaAllocator<U> &rhs) const
+    {return mArena != rhs.GetArena();}
+
+private:
+   Arena *mArena;
+};
+
+#endif
@@ -9,37 +9,49 @@
 #define BASICKEY_H_
 
 #include "Board.h"
+#include "Arena.h"
+#include "SlabPool.h"
 #include "MyLib.h"
 
+// A Key of X unsigned longs, given at construction, or all zero.  The longs
+// are the Key's block, and are written to files as binary longs.  With X
+// fixed, comparisons loop over a known count and need no downcast checks.
 template <unsigned int X>
 class BasicKey : public Board::Key {
 public:
-	unsigned long vals[X];
+	BasicKey() : vals() {mHash = Hash(vals, X);}
+	BasicKey(const unsigned long (&words)[X]) {
+	   memcpy(vals, words, sizeof(vals));
+	   mHash = Hash(vals, X);
+	}
 
-	// Compare two keys for equality or less-than.
-	bool operator==(const Board::Key &) const;
-	bool operator<(const Board::Key &) const;
+	const uchar *GetBytes() const {return (const uchar *)vals;}
+	int GetSize() const {return sizeof(vals);}
 
-	// Override new and delete in order to maintain freelists
-	// and mOutstanding count
+	// Override new and delete in order to maintain pools
+	// and MemStats counts
 	static void *operator new(size_t);
 	static void operator delete(void *p);
 
    const Class *GetClass() const { return &mClass; }
 
 protected:
+	bool Equals(const Board::Key &key) const {
+	   return memcmp(vals, static_cast<const BasicKey &>(key).vals,
+	    sizeof(vals)) == 0;
+	}
+	bool Less(const Board::Key &key) const;
+
 	std::istream &Read(std::istream &);
 	std::ostream &Write(std::ostream &) const;
 
 private:
+	unsigned long vals[X];
+
    static Class mClass;
    static Object *CreateBasicKey();
-	static std::vector<BasicKey *> mFreeList;
 };
 
-template <unsigned int X>
-std::vector<BasicKey<X> *> BasicKey<X>::mFreeList;
-
 template <unsigned int X>
 Object *BasicKey<X>::CreateBasicKey() {
    return new BasicKey<X>;
@@ -48,68 +60,54 @@ Object *BasicKey<X>::CreateBasicKey() {
 template <unsigned int X>
 Class BasicKey<X>::mClass(FString("BasicKey<%d>", X), &CreateBasicKey);
 
-template <unsigned int X>
-bool BasicKey<X>::operator==(const Board::Key &key) const {
-	// downcast to a const BasicKey<X> here
-	const BasicKey<X> *castedKey = dynamic_cast<const BasicKey<X> *>(&key);
-	assert(castedKey != NULL);
-
-	for (unsigned int i = 0; i < X; i++)
-		if (this->vals[i] != castedKey->vals[i])
-			return false;
-	return true;
-}
-
-template <unsigned int X>
-bool BasicKey<X>::operator<(const Board::Key &key) const {
-	// downcast to a const BasicKey<X> here
-	const BasicKey<X> *castedKey = dynamic_cast<const BasicKey<X> *>(&key);
-	assert(castedKey != NULL);
-
-	for (unsigned int i = 0; i < X; i++) {
-		if (this->vals[i] < castedKey->vals[i])
-			return true;
-		else if (this->vals[i] > castedKey->vals[i])
-			return false;
-	}
-
-	// == case.
-	return false;
-}
-
+// Allocate from the current search's Arena, if any, or else the pool.
 template <unsigned int X>
 void *BasicKey<X>::operator new(size_t size) {
-	void *temp;
+	void *temp = Arena::AllocCurrent(size);
 
-	if (mFreeList.size()) {
-	  temp = mFreeList.back();
-	  mFreeList.pop_back();
-	} else {
-	  temp = ::new char[size];
-	}
+	if (!temp)
+	   temp = SlabPool<BasicKey>::Alloc();
 
-	mOutstanding++;
+	MemStats::Alloc(MemStats::kKey, sizeof(BasicKey));
 	return temp;
 }
 
 template <unsigned int X>
 void BasicKey<X>::operator delete(void *p) {
-	mFreeList.push_back((BasicKey *)p);
-	mOutstanding--;
+	if (!Arena::FreeCurrent(p, sizeof(BasicKey)))
+	   SlabPool<BasicKey>::Free(p);
+	MemStats::Free(MemStats::kKey, sizeof(BasicKey));
+}
+
+// Order keys by their longs, first to last.
+template <unsigned int X>
+bool BasicKey<X>::Less(const Board::Key &key) const {
+	const unsigned long *other = static_cast<const BasicKey &>(key).vals;
+	unsigned int i;
+
+	for (i = 0; i < X && vals[i] == other[i]; i++)
+		;
+	return i < X && vals[i] < other[i];
 }
 
 template <unsigned int X>
 std::istream &BasicKey<X>::Read(std::istream &in) {
+	in.read((char *)vals, sizeof(vals));
 	for (unsigned int i = 0; i < X; i++)
-		in >> vals[i];
+		vals[i] = EndianXfer(vals[i]);
+	mHash = Hash(vals, X);
 
 	return in;
 }
 
 template <unsigned int X>
 std::ostream &BasicKey<X>::Write(std::ostream &out) const {
-	for (unsigned int i = 0; i < X; i++)
-		out << vals[i];
+	unsigned long val;
+
+	for (unsigned int i = 0; i < X; i++) {
+		val = EndianXfer(vals[i]);
+		out.write((char *)&val, sizeof(val));
+	}
 
 	return out;
 }
@@ -0,0 +1,119 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <chrono>
+#include <deque>
+#include <thread>
+#include "Class.h"
+#include "Board.h"
+#include "MemStats.h"
+#include "SearchService.h"
+#include "SearchStats.h"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+// Searches kept in flight per worker, so that each worker has its next
+// board queued while the oldest result is awaited.
+const int kQueuePerWorker = 4;
+
+// Write one result line: position number, move, reply, value, depth and
+// boards examined, separated by tabs.  A board with the game over gets "-"
+// for its moves.  *brd, any board of the class, decodes the moves.
+static void WriteResult(ostream &out, const Board *brd, long ndx,
+ const BestMove &res) {
+   out << ndx << '\t' << (res.HasMove() ? brd->GetMoveText(res.move) : "-")
+    << '\t' << (res.HasReply() ? brd->GetMoveText(res.replyMove) : "-")
+    << '\t' << res.value << '\t' << res.depth << '\t' << res.numBoards
+    << '\n';
+}
+
+// Write the oldest pending search's result, once it is done, and add its
+// counts to *total.
+static void WriteOldest(ostream &out, const Board *brd, long ndx,
+ deque<future<BestMove> > *pending, deque<SearchStats> *stats,
+ SearchStats *total) {
+   WriteResult(out, brd, ndx, pending->front().get());
+   *total += stats->front();
+   pending->pop_front();
+   stats->pop_front();
+}
+
+// Find best moves for a file of boards.  Usage:
+//
+// BatchAnalyze BoardClass depth seconds threads inFile outFile
+//
+// inFile holds boards back to back, each as BoardTest's saveBoard writes
+// one (so several saved boards may simply be concatenated).  Each is
+// searched to 'depth', or for 'seconds' if that is more than 0, on a pool
+// of 'threads' workers (0 for one per core).  outFile gets one line per
+// board, in input order, as WriteResult writes it.  Boards are read as the
+// pool has room for them, so the file may be of any size.  The run ends with
+// the SearchStats of all the searches together, and MemStats' counts.
+int main(int argc, char **argv) {
+   const BoardClass *boardClass = argc > 1 ? dynamic_cast<const BoardClass *>(
+    BoardClass::ForName(argv[1])) : NULL;
+   int threads = argc > 4 ? atoi(argv[4]) : -1;
+   SearchService::Request req(argc > 2 ? atoi(argv[2]) : 0);
+   deque<future<BestMove> > pending;
+   deque<SearchStats> stats;          // One per pending search
+   SearchStats total;
+   Clock::time_point start = Clock::now();
+   ifstream in;
+   ofstream out;
+   Board *brd, *codec;
+   long read = 0, written = 0;
+   double elapsed;
+
+   req.seconds = argc > 3 ? atof(argv[3]) : -1.0;
+   if (threads == 0)
+      threads = TMax((int)thread::hardware_concurrency(), 1);
+   if (argc != 7 || !boardClass || req.maxDepth < 1 || req.seconds < 0.0
+    || threads < 1) {
+      cout << "Usage: BatchAnalyze BoardClass depth seconds threads inFile "
+       "outFile" << endl;
+      return -1;
+   }
+
+   in.open(argv[5], ios::binary);
+   out.open(argv[6]);
+   if (!in || !out) {
+      cout << "Can't open " << (!in ? argv[5] : argv[6]) << endl;
+      return -1;
+   }
+
+   SearchService service(threads);
+   codec = dynamic_cast<Board *>(boardClass->NewInstance());
+
+   while (in.peek() != EOF) {
+      brd = dynamic_cast<Board *>(boardClass->NewInstance());
+      in >> *brd;
+      if (!in) {
+         cout << "Board " << read + 1 << " is incomplete" << endl;
+         delete brd;
+         break;
+      }
+      stats.emplace_back();
+      req.stats = &stats.back();
+      pending.push_back(service.Submit(brd, req));
+      delete brd;
+      read++;
+
+      if ((int)pending.size() >= threads * kQueuePerWorker)
+         WriteOldest(out, codec, ++written, &pending, &stats, &total);
+   }
+   while (pending.size())
+      WriteOldest(out, codec, ++written, &pending, &stats, &total);
+   delete codec;
+
+   elapsed = chrono::duration<double>(Clock::now() - start).count();
+   cout << written << " positions in " << elapsed << "s on " << threads
+    << " threads: " << written / elapsed << " positions/s" << endl;
+   cout << "stats ";
+   total.Write(cout);
+   cout << endl;
+   MemStats::Dump(cout);
+
+   return 0;
+}
@@ -3,28 +3,58 @@
 
 #include "Board.h"
 
-// BestMove accepts ownership of the Move given it via its main constructor.
-// Since it has ownership of a dynamic object, it requires a copy
-// constructor, operator=, and destructor.
+// BestMove holds its moves by value, as Move::GetCode codes, so that it
+// copies, and goes into a transposition table, without allocating or
+// cloning anything.  Board::DecodeMove turns a code back into a Move where
+// one is needed, e.g. to apply or print it.
 struct BestMove {
-   Board::Move *move;      // The best move to take (owned by the BestMove)
-   Board::Move *replyMove; // The best move to take in reply to 'move'
+   uint move;              // Code of the best move to take, or kNoCode
+   uint replyMove;         // Code of the best reply to 'move', or kNoCode
    long value;             // The board value that will result from the move
    long depth;             // Levels of minimax that were used to get move
    long numBoards;         // Number of boards explored to get move
    
-   BestMove() : move(NULL), replyMove(NULL), value(0), depth(0), numBoards(0) {}
-   BestMove(Board::Move *mv, Board::Move *reply, long val, int dpt, long brds) :
-    move(mv), replyMove(reply), value(val), depth(dpt), numBoards(brds) {}
+   BestMove() : move(Board::Move::kNoCode), replyMove(Board::Move::kNoCode),
+    value(0), depth(0), numBoards(0)
+    {MemStats::Alloc(MemStats::kBestMove, sizeof(BestMove));}
+   BestMove(uint mv, uint reply, long val, int dpt, long brds) :
+    move(mv), replyMove(reply), value(val), depth(dpt), numBoards(brds)
+    {MemStats::Alloc(MemStats::kBestMove, sizeof(BestMove));}
+   BestMove(const BestMove &src) : move(src.move), replyMove(src.replyMove),
+    value(src.value), depth(src.depth), numBoards(src.numBoards)
+    {MemStats::Alloc(MemStats::kBestMove, sizeof(BestMove));}
+   BestMove &operator=(const BestMove &src) = default;
    
-   BestMove(const BestMove &mv);
-   const BestMove &operator=(const BestMove &mv);
+   ~BestMove() {MemStats::Free(MemStats::kBestMove, sizeof(BestMove));}
    
-   ~BestMove();
-   
-   void SetBestMove(Board::Move *mv) {delete move; move = mv;}
-   void SetReplyMove(Board::Move *mv) {delete replyMove; replyMove = mv;}
+   bool HasMove() const  {return move != Board::Move::kNoCode;}
+   bool HasReply() const {return replyMove != Board::Move::kNoCode;}
+
+   // Drop both moves and restart the result at depth 'dpt'.
+   void Clear(long dpt, long brds) {
+      move = replyMove = Board::Move::kNoCode;
+      value = 0;
+      depth = dpt;
+      numBoards = brds;
+   }
    
 };
 
+// PVLine is the principal variation from a searched board: the line of play
+// the search expects, best move first, up to kMaxPly halfmoves.  Like
+// BestMove, it holds move codes, so it is a plain array that copies freely.
+// Passed into a search, it also seeds move ordering: each of its moves is
+// tried first while the search follows the line.
+struct PVLine {
+   enum {kMaxPly = 64};
+
+   uint moves[kMaxPly];    // Codes of the moves in the line
+   int length;
+
+   PVLine() : length(0) {}
+
+   void Clear() {length = 0;}
+   void Append(uint code) {if (length < kMaxPly) moves[length++] = code;}
+};
+
 #endif
\ No newline at end of file
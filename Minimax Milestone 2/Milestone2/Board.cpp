@@ -8,6 +8,71 @@
 #include "Board.h"
 #include <climits>
 
+using namespace std;
+
 const long Board::kWinVal = LONG_MAX / 4;
-long Board::Move::mOutstanding = 0;
-long Board::Key::mOutstanding = 0;
+
+// Mix in each word by a multiply and a rotate, and finish with the 
+// MurmurHash3 64-bit finalizer, so that every input bit can change every
+// bit of the hash.
+ulong Board::Key::Hash(const ulong *words, int numWords) {
+   const ulong kMul = 0x9E3779B97F4A7C15UL;
+   ulong hash = numWords * kMul;
+   int ndx;
+
+   for (ndx = 0; ndx < numWords; ndx++) {
+      hash = (hash ^ words[ndx]) * kMul;
+      hash = hash << 31 | hash >> 33;
+   }
+
+   hash ^= hash >> 33;
+   hash *= 0xFF51AFD7ED558CCDUL;
+   hash ^= hash >> 33;
+   hash *= 0xC4CEB9FE1A85EC53UL;
+   return hash ^ hash >> 33;
+}
+
+int Board::Playout(XorShift *rng, int maxPlies) {
+   list<Move *> moves;
+   int plies, pick;
+   long value;
+
+   for (plies = 0; plies < maxPlies; plies++) {
+      GetAllMoves(&moves);
+      if (moves.size() == 0)
+         break;
+      for (pick = rng->Below(moves.size()); moves.size(); moves.pop_front(),
+       pick--)
+         if (pick == 0)
+            ApplyMove(moves.front());
+         else
+            delete moves.front();
+   }
+
+   value = GetValue();
+   for (; plies > 0; plies--)
+      UndoLastMove();
+
+   return value > 0 ? 1 : value < 0 ? -1 : 0;
+}
+
+Board::Move *Board::DecodeMove(uint code) const {
+   Move *move = CreateMove();
+
+   try {
+      move->SetCode(code);
+   }
+   catch (...) {
+      delete move;
+      throw;
+   }
+   return move;
+}
+
+string Board::GetMoveText(uint code) const {
+   Move *move = DecodeMove(code);
+   string rtn = *move;
+
+   delete move;
+   return rtn;
+}
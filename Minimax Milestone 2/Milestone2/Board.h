@@ -4,7 +4,11 @@
 #include <list>
 #include <string>
 #include <map>
+#include <atomic>
+#include <string.h>
 #include "Class.h"
+#include "MemStats.h"
+#include "MyLib.h"
 
 #pragma warning(disable:4786)
 
@@ -14,23 +18,33 @@ public:
 
    class Move {
    public:
+      // A code that no move has, for "no move" wherever codes are stored.
+      enum {kNoCode = 0xFFFFFFFF};
+
       virtual ~Move() {};
       virtual Move *Clone() const = 0;
       virtual bool operator==(const Move &) const = 0;
       virtual bool operator<(const Move &) const = 0;
       virtual operator std::string() const = 0;
       virtual void operator=(const std::string &src) = 0;
+
+      // Return a 32-bit code for the move, from which SetCode restores it
+      // exactly (as operator== judges), for storing moves compactly.  Codes
+      // are meaningful only among moves of one class.  SetCode throws a
+      // BaseException for a code that no move of the class has.
+      virtual uint GetCode() const = 0;
+      virtual void SetCode(uint code) = 0;
+
       friend std::ostream &operator<<(std::ostream &os, const Move &m)
        {return m.Write(os);}
       friend std::istream &operator>>(std::istream &is, Move &m)
        {return m.Read(is);}
 
-      static long GetOutstanding() {return mOutstanding;}
+      static long GetOutstanding() {return MemStats::GetLive(MemStats::kMove);}
 
    protected:
       virtual std::istream &Read(std::istream &) = 0;
       virtual std::ostream &Write(std::ostream &) const = 0;
-      static long mOutstanding;
    };
 
    // Base class for keys returned by getKey and used in the transposition
@@ -38,30 +52,71 @@ public:
    // should not be used with a transposition table.  Key-derived classes
    // must not have any dynamically allocated data, since they are 
    // written and read to and from binary files as a single block of bytes.
+   //
+   // Key holds a 64-bit hash of that block, which the derived class sets
+   // whenever it sets the block: at construction, and in Read.  The hash
+   // never changes otherwise, so keys may be read from several threads at
+   // once.  Equality checks the hash before asking the derived class, so
+   // unequal keys almost never cost a virtual call.  Keys compared must be
+   // of the same class, as all keys from one Board class are.
    class Key : public Object {
    public:
+      // Hash functor for unordered containers of Key pointers, such as Book.
+      // It takes the containers' TCmpPtr itself, and is noexcept, so that
+      // libstdc++ sees a cheap hash and stores no copy of it in each node.
+      struct PtrHash {
+         size_t operator()(const TCmpPtr<const Key> &key) const noexcept
+          {return key->GetHash();}
+      };
+
       virtual ~Key() {};
 
+      // Return the key's bytes, and how many there are.
+      virtual const uchar *GetBytes() const = 0;
+      virtual int GetSize() const = 0;
+
+      // Return a 64-bit hash of the bytes.
+      ulong GetHash() const {return mHash;}
+
       // Compare two keys for equality or less-than.
-      virtual bool operator==(const Key &) const = 0;
-      virtual bool operator<(const Key &) const = 0;
+      bool operator==(const Key &key) const
+       {return mHash == key.mHash && Equals(key);}
+      bool operator<(const Key &key) const {return Less(key);}
 
       friend std::ostream &operator<<(std::ostream &os, const Key &k)
        {return k.Write(os);}
       friend std::istream &operator>>(std::istream &is, Key &k)
        {return k.Read(is);}
 
-      static long GetOutstanding() {return mOutstanding;}
+      static long GetOutstanding() {return MemStats::GetLive(MemStats::kKey);}
 
    protected:
+      Key() : mHash(0) {}
+
+      // Compare the bytes of this key and 'key', which is of this class.
+      virtual bool Equals(const Key &key) const = 0;
+      virtual bool Less(const Key &key) const = 0;
+
       virtual std::istream &Read(std::istream &) = 0;
       virtual std::ostream &Write(std::ostream &) const = 0;
 
-      static long mOutstanding;
+      static ulong Hash(const ulong *words, int numWords);
+
+      ulong mHash;              // Hash of the bytes, set whenever they are
    };
       
    virtual ~Board() {}
 
+   // Count Boards made with new in MemStats.
+   static void *operator new(size_t sz) {
+      MemStats::Alloc(MemStats::kBoard, sz);
+      return ::operator new(sz);
+   }
+   static void operator delete(void *p, size_t sz) {
+      MemStats::Free(MemStats::kBoard, sz);
+      ::operator delete(p);
+   }
+
    // Return current estimated value of board.
    virtual long GetValue() const = 0;
 
@@ -77,9 +132,33 @@ public:
    // list iff the game is over.
    virtual void GetAllMoves(std::list<Move *> *) const = 0;
 
+   // Return via out parameter the "capture" moves from this board: those
+   // that remove material, after which a static GetValue is unreliable.
+   // Caller owns the moves.  Return true if the player must choose among
+   // them (so may not simply stand on the current value).  Boards with no
+   // notion of capture return an empty list, as this default does.
+   virtual bool GetCaptureMoves(std::list<Move *> * /*moves*/) const
+    {return false;}
+
+   // Play random moves, chosen by *rng, to the end of the game or for at most
+   // maxPlies halfmoves, and return 1 if player 0 won, -1 if player 1 won,
+   // and 0 for a draw or an unfinished game that neither side leads.  The
+   // board is left as it was.  This default plays through GetAllMoves and
+   // ApplyMove, judging an unfinished game by GetValue; boards override it
+   // with a kernel that plays on a copy of their own state, without
+   // allocating.
+   virtual int Playout(XorShift *rng, int maxPlies);
+
    // Create a default-constructed move of the appropriate type for this board.
    virtual Move *CreateMove() const = 0;
 
+   // Create a move of the appropriate type from a code given by
+   // Move::GetCode.  Caller owns the move.
+   Move *DecodeMove(uint code) const;
+
+   // Return the text of the move whose code is 'code', as (string)*move.
+   std::string GetMoveText(uint code) const;
+
    // Get whose move it is, numbering from 0 as first player.
    virtual int GetWhoseMove() const = 0;
 
@@ -92,6 +171,13 @@ public:
    // Return a Key object for use with transposition table.  Caller owns the
    // key.
    virtual const Key *GetKey() const = 0;
+
+   // Per-board Rules accessor/mutator, used by GetValue.  GetRules returns a
+   // dynamically allocated copy of this board's Rules, owned by the caller.
+   // SetRules copies the Rules given; caller retains ownership.  Boards start
+   // with their BoardClass's default Rules (see BoardClass::SetOptions).
+   virtual void *GetRules() const = 0;
+   virtual void SetRules(const void *) = 0;
    
    // Binary writing/reading overloads
    friend std::ostream &operator<<(std::ostream &os, const Board &b)
@@ -104,4 +190,11 @@ protected:
    virtual std::ostream &Write(std::ostream &) const = 0;
 };
 
+// GameTraits<B> names the classes that go with Board class B, for code
+// templated on B (see MinimaxT).  Each game specializes it beside its Move
+// class; the default serves any Board through the base classes.
+template <class B> struct GameTraits {
+   typedef Board::Move Move;
+};
+
 #endif
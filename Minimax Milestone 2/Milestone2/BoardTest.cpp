@@ -7,6 +7,9 @@
 #include "Board.h"
 #include "View.h"
 #include "Dialog.h"
+#include "PNSearch.h"
+#include "MCTSPlayer.h"
+#include "SearchService.h"
 #include <exception>
 #include <climits>
 #include <cstdlib>
@@ -110,7 +113,7 @@ int main(int argc, char **argv) {
    }
 
    // Attempt to instantiate the boardClass object
-   boardClass = BoardClass::ForName(argv[1]);
+   boardClass = dynamic_cast<const BoardClass *>(BoardClass::ForName(argv[1]));
    if (boardClass == NULL) {
       cout << "Failed to create classes or objects" << endl;
       return -1;
@@ -250,9 +253,11 @@ int main(int argc, char **argv) {
             // Flush until '\n'
             cin.ignore(INT_MAX, '\n');
 
-            // Run the dialog, using the Options object
-            void *options = boardClass->GetOptions();
+            // Run the dialog on this board's Rules, and make them the
+            // default for any boards created later as well.
+            void *options = board->GetRules();
             dialog->Run(cin, cout, options);
+            board->SetRules(options);
             boardClass->SetOptions(options);
 
          } else if (command.compare("showVal") == 0) {
@@ -442,6 +447,95 @@ int main(int argc, char **argv) {
                allMoves.clear();
             }
 
+         } else if (command.compare("solve") == 0) {
+            // Prove a win for the player to move, or else try to prove a 
+            // win for the opponent, each within the given node count.
+            PNSearch::Result result, oppResult = PNSearch::kUnknown;
+            Board::Move *winMove = NULL;
+            long maxNodes = -1;
+
+            cin >> maxNodes;
+            cin.ignore(10000, '\n');
+            if (maxNodes <= 0)
+               throw BaseException("Bad node count for solve");
+
+            PNSearch pns(maxNodes), oppPns(maxNodes);
+            const PNSearch *shown = &pns;
+
+            result = pns.Solve(board, board->GetWhoseMove(), &winMove);
+            if (result == PNSearch::kDisproven) {
+               oppResult = oppPns.Solve(board, 1 - board->GetWhoseMove());
+               shown = &oppPns;
+            }
+
+            if (result == PNSearch::kProven) {
+               cout << "Win for player to move";
+               if (winMove)
+                  cout << " with " << (string)*winMove;
+               cout << endl;
+               delete winMove;
+            }
+            else if (oppResult == PNSearch::kProven)
+               cout << "Loss for player to move" << endl;
+            else if (result == PNSearch::kDisproven)
+               cout << "No forced win for player to move" << endl;
+            else
+               cout << "Unsolved within " << maxNodes << " nodes" << endl;
+
+            cout << "Proof size: " << shown->GetStats().proofSize 
+             << " boards, searched " << shown->GetStats().nodes
+             << " boards in " << shown->GetStats().seconds << "s" << endl;
+         } else if (command.compare("mcts") == 0) {
+            // Choose a move by Monte Carlo tree search, with the given 
+            // playout count spread over the given number of threads.
+            MCTSPlayer::Options opts;
+            BestMove bestMove;
+
+            opts.iterations = opts.threads = -1;
+            cin >> opts.iterations >> opts.threads;
+            cin.ignore(10000, '\n');
+            if (opts.iterations <= 0 || opts.threads <= 0)
+               throw BaseException("Bad playout or thread count for mcts");
+
+            MCTSPlayer::Search(board, opts, &bestMove);
+            if (bestMove.HasMove()) {
+               cout << "Best move " << board->GetMoveText(bestMove.move);
+               if (bestMove.HasReply())
+                  cout << ", reply " << board->GetMoveText(bestMove.replyMove);
+               cout << endl;
+            }
+            cout << "Value " << bestMove.value << " after "
+             << bestMove.numBoards << " playouts, tree depth "
+             << bestMove.depth << endl;
+         } else if (command.compare("search") == 0) {
+            // Search iteratively deeper in the background, to the given
+            // depth or for the given seconds, reporting each level.
+            SearchService service;
+            SearchService::Request req;
+            BestMove bestMove;
+
+            req.maxDepth = -1;
+            cin >> req.maxDepth >> req.seconds;
+            cin.ignore(10000, '\n');
+            if (req.maxDepth <= 0 || req.seconds < 0.0)
+               throw BaseException("Bad depth or time for search");
+
+            req.progress = [board](const SearchService::Progress &prg) {
+               cout << "Depth " << prg.depth << ": " << (prg.best->HasMove() ?
+                board->GetMoveText(prg.best->move) : "none") << " value " 
+                << prg.best->value << " after " << prg.numBoards 
+                << " boards" << endl;
+            };
+            bestMove = service.Submit(board, req).get();
+            if (bestMove.HasMove()) {
+               cout << "Best move " << board->GetMoveText(bestMove.move);
+               if (bestMove.HasReply())
+                  cout << ", reply " << board->GetMoveText(bestMove.replyMove);
+               cout << endl;
+            }
+            cout << "Value " << bestMove.value << " at depth "
+             << bestMove.depth << " after " << bestMove.numBoards
+             << " boards" << endl;
          } else if (command.compare("keyMoveCount") == 0) {
             cout << "Moves/Keys: " << Board::Move::GetOutstanding()
              << "/" << Board::Key::GetOutstanding() << endl;
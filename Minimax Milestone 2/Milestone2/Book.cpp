@@ -1,6 +1,8 @@
 #include "Book.h"
 #include "Board.h"
 #include <assert.h>
+#include <vector>
+#include <algorithm>
 
 using namespace std;
 
@@ -17,55 +19,89 @@ Book::~Book() {
 // [Staley] When you read the book, assume that the depth of the BestMove is
 // [Staley] the "level" of the book file.
 // [Staley] Also, assume that the number of boards explored is 0.
+//
+// Moves are stored as their Move::GetCode codes, in file byte order.
 istream &Book::Read(istream &is, const Class *boardClass) {
    Board *board = dynamic_cast<Board*>(boardClass->NewInstance());
    Board::Move *move = board->CreateMove(), *replyMove = board->CreateMove();
    Board::Key *key;
    char tempChar;
+   uint code = 0, replyCode = 0;
    long tempValue = 0;
    
    is.read(&tempChar, sizeof(tempChar));
    mLevel = tempChar;
    
-   while (!is.eof()) {
+   // Stop at the end of the file, or at the first entry that can't be read
+   // whole, rather than inserting it.
+   while (is.peek() != EOF) {
       // Hack here, but eff it at this point  ~_~.
       key = const_cast<Board::Key *> (board->GetKey());
       is >> *key;
-      is >> *move;
+      is.read((char*)&code, sizeof(code));
+      code = EndianXfer(code);
       is.read(&tempChar, sizeof(char));
+      replyCode = Board::Move::kNoCode;
       if (tempChar == 1) {
-         is >> *replyMove;
+         is.read((char*)&replyCode, sizeof(replyCode));
+         replyCode = EndianXfer(replyCode);
       }
       is.read((char*)&tempValue, sizeof(tempValue));
-      
-      insert(value_type(key, BestMove(move->Clone(), tempChar == 1 ?
-       replyMove->Clone() : NULL, EndianXfer(tempValue), mLevel, 0)));
+
+      // Check that the codes are ones the board class has.
+      try {
+         if (is) {
+            move->SetCode(code);
+            if (tempChar == 1)
+               replyMove->SetCode(replyCode);
+         }
+      }
+      catch (BaseException &exc) {
+         is.setstate(ios::failbit);
+      }
+      if (!is || !insert(value_type(key, BestMove(code, replyCode,
+       EndianXfer(tempValue), mLevel, 0))).second) {
+         delete key;
+         if (!is)
+            break;
+      }
    }
    
    delete board;
    delete move;
+   delete replyMove;
    
    return is;
 }
 
 // Same thing as Read(), but with less assumptions.
 ostream &Book::Write(ostream &os) {
-   Book::iterator bookIter;
+   vector<value_type *> entries;
+   vector<value_type *>::iterator bookIter;
    char tempChar = mLevel;
+   uint code;
    long tempValue;
    
    os.write(&tempChar, sizeof(tempChar));
+
+   for (iterator itr = begin(); itr != end(); ++itr)
+      entries.push_back(&*itr);
+   sort(entries.begin(), entries.end(),
+    [](const value_type *e1, const value_type *e2)
+    {return *e1->first < *e2->first;});
    
-   for (bookIter = begin(); bookIter != end(); ++bookIter) {
-      os << *(bookIter->first);
-      os << *(bookIter->second.move);
-      tempChar = bookIter->second.replyMove ? 1 : 0;
+   for (bookIter = entries.begin(); bookIter != entries.end(); ++bookIter) {
+      os << *((*bookIter)->first);
+      code = EndianXfer((*bookIter)->second.move);
+      os.write((char*)&code, sizeof(code));
+      tempChar = (*bookIter)->second.HasReply() ? 1 : 0;
       os.write(&tempChar, sizeof(tempChar));
       if (tempChar == 1) {
-         os << *(bookIter->second.replyMove);
+         code = EndianXfer((*bookIter)->second.replyMove);
+         os.write((char*)&code, sizeof(code));
       }
       
-      tempValue = EndianXfer(bookIter->second.value);
+      tempValue = EndianXfer((*bookIter)->second.value);
       os.write((char*)&tempValue, sizeof(tempValue));
    }
    
@@ -1,25 +1,74 @@
 #ifndef BOOK_H
 #define BOOK_H
 
-#include <map>
+#include <unordered_map>
 #include <iostream>
+#include <type_traits>
 #include "Class.h"
 #include "BestMove.h"
+#include "Arena.h"
 #include "MyLib.h"
 
-class Book : public std::map<TCmpPtr<const Board::Key>, BestMove> {
+// An ArenaAllocator that counts a Book's nodes, and the bytes of its nodes
+// and bucket arrays, as MemStats::kBookEntry.
+template <class T>
+class BookAllocator : public ArenaAllocator<T> {
 public:
-   Book() : mLevel(0) {}
+   template <class U> struct rebind {typedef BookAllocator<U> other;};
+
+   BookAllocator(Arena *arena = NULL) : ArenaAllocator<T>(arena) {}
+   template <class U>
+   BookAllocator(const BookAllocator<U> &src)
+    : ArenaAllocator<T>(src.GetArena()) {}
+
+   T *allocate(size_t n) {
+      MemStats::Alloc(MemStats::kBookEntry, n * sizeof(T), NumNodes(n));
+      return ArenaAllocator<T>::allocate(n);
+   }
+
+   void deallocate(T *p, size_t n) {
+      MemStats::Free(MemStats::kBookEntry, n * sizeof(T), NumNodes(n));
+      ArenaAllocator<T>::deallocate(p, n);
+   }
+
+private:
+   // Bucket arrays are arrays of pointers; everything else is a node.
+   static long NumNodes(size_t n) {return std::is_pointer<T>::value ? 0 : n;}
+};
+
+typedef std::unordered_map<TCmpPtr<const Board::Key>, BestMove,
+ Board::Key::PtrHash, std::equal_to<TCmpPtr<const Board::Key> >,
+ BookAllocator<std::pair<const TCmpPtr<const Board::Key>, BestMove> > >
+ BookMap;
+
+// Map from board keys to their best moves, hashed by Key::GetHash.  Serves 
+// both as an opening book and as a transposition table.
+//
+// A table used by only one search may keep its entries in that search's
+// Arena, given at construction, and must then be deleted while that Arena
+// is current.  Keys and moves put into a Book must be allocated while its
+// Arena (or, for a Book on the heap, none) is current.
+class Book : public BookMap {
+public:
+   Book(Arena *arena = NULL)
+    : BookMap(0, hasher(), key_equal(), allocator_type(arena)), mLevel(0),
+    mArena(arena) {}
    virtual ~Book();
    
    int GetLevel()          {return mLevel;}
    void SetLevel(int val)  {mLevel = val;}
+
+   // The Arena holding the entries, or NULL if they are on the heap.
+   Arena *GetArena() const {return mArena;}
    
    std::istream &Read(std::istream &is, const Class *brdCls);
+
+   // Write the entries in key order, so that equal books make equal files.
    std::ostream &Write(std::ostream &os);
    
 protected:
    short mLevel;
+   Arena *mArena;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef CANCELTOKEN_H
+#define CANCELTOKEN_H
+
+#include <atomic>
+#include <chrono>
+
+// A flag by which one thread asks a search running on another to stop.  A
+// token may also cancel itself once a time limit passes, and may follow a
+// parent token, counting as cancelled whenever the parent is.  Searches poll
+// IsCancelled once per board, so it costs only an atomic load (and a clock
+// read, if timed) per token in the chain.
+class CancelToken {
+public:
+   typedef std::chrono::steady_clock Clock;
+
+   // A token with 'seconds' > 0 cancels itself that long after construction.
+   CancelToken(const CancelToken *parent = NULL, double seconds = 0.0)
+    : mCancelled(false), mParent(parent), mTimed(seconds > 0.0) {
+      mDeadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+       std::chrono::duration<double>(seconds));
+   }
+
+   void Cancel() {mCancelled = true;}
+
+   bool IsCancelled() const {
+      return mCancelled.load(std::memory_order_relaxed)
+       || (mTimed && Clock::now() >= mDeadline)
+       || (mParent && mParent->IsCancelled());
+   }
+
+private:
+   CancelToken(const CancelToken &);
+   void operator=(const CancelToken &);
+
+   std::atomic<bool> mCancelled;
+   const CancelToken *mParent;
+   bool mTimed;
+   Clock::time_point mDeadline;
+};
+
+#endif
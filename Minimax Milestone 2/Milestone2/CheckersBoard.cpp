@@ -8,73 +8,75 @@
 #include "CheckersBoard.h"
 #include "MyLib.h"
 #include "BasicKey.h"
+#include "MinimaxEngine.h"
 
 using namespace std;
 
+// Build the cell table.  Run by the compiler, once, for mTables.  Cells
+// are numbered from row H down to row A, and left to right within a row;
+// the playing squares are those with row + col even, counting A1 as 0, 0.
+constexpr CheckersBoard::Tables CheckersBoard::MakeTables() {
+   Tables tbl = {};
+   int row = 0, col = 0, dir = 0, nextCell = 0, toRow = 0, toCol = 0;
+   const int rowDeltas[kSqr] = {-1, -1, 1, 1}; // By kSW, kSE, kNW, kNE
+   const int colDeltas[kSqr] = {-1, 1, -1, 1};
+
+   for (row = 0; row < kWidth; row++)
+      for (col = 0; col < kWidth; col++)
+         tbl.cellAt[row][col] = (row + col) % 2 ? kNoCell
+          : (kWidth - 1 - row) * kDim + col / 2;
+
+   for (row = 0; row < kWidth; row++) {
+      for (col = row % 2; col < kWidth; col += 2, nextCell++) {
+         Cell &cell = tbl.cells[tbl.cellAt[row][col]];
+
+         cell.mask = 1UL << tbl.cellAt[row][col];
+         cell.row = 'A' + row;
+         cell.col = col + 1;
+         tbl.byLoc[nextCell] = tbl.cellAt[row][col];
+
+         for (dir = 0; dir < kSqr; dir++) {
+            cell.neighbors[dir] = cell.landings[dir] = kNoCell;
+
+            toRow = row + rowDeltas[dir];
+            toCol = col + colDeltas[dir];
+            if (InRange(0, toRow, kWidth) && InRange(0, toCol, kWidth)) {
+               cell.neighbors[dir] = tbl.cellAt[toRow][toCol];
+               cell.steps[dir] = 1UL << cell.neighbors[dir];
+            }
+
+            toRow += rowDeltas[dir];
+            toCol += colDeltas[dir];
+            if (InRange(0, toRow, kWidth) && InRange(0, toCol, kWidth)) {
+               cell.landings[dir] = tbl.cellAt[toRow][toCol];
+               cell.jumps[dir] = 1UL << cell.landings[dir];
+            }
+         }
+      }
+   }
+
+   return tbl;
+}
+
 /************************************************************************/
 /* Declare/initialize static member datum here                          */
 /************************************************************************/
-CheckersBoard::Rules CheckersBoard::mRules;
-CheckersBoard::Cell CheckersBoard::mCells[kNumCells];
-ulong CheckersBoard::mBlackBackSet, CheckersBoard::mWhiteBackSet;
+CheckersBoard::Rules CheckersBoard::mDefaultRules;
+const CheckersBoard::Tables CheckersBoard::mTables = MakeTables();
+constexpr CheckersBoard::Set CheckersBoard::mWhiteBackSet;
+constexpr CheckersBoard::Set CheckersBoard::mBlackBackSet;
 
 BoardClass CheckersBoard::mClass("CheckersBoard", &CreateCheckersBoard,
  "Checkers", &CheckersView::mClass, &CheckersDlg::mClass,
  &CheckersBoard::SetOptions, &CheckersBoard::GetOptions, true);
 
-// The C++ definition here isn't required in C++11, which I'm using.
-// Put it there anyways to force the "static block" to run.
-CheckersBoard::CheckersBoardInitializer CheckersBoard::mInitializer;
-
-
-void CheckersBoard::StaticInit() {
-   Cell *cell;
-   char row = 'A';
-   unsigned int col = 1, nextCell = 0;
-
-   // Initialize mCells, mBlackBackRow and mWhiteBackRow
-   for (row = 'H'; row >= 'A'; row--) {
-      for (col = ((row-'A')%2) + 1; col <= kWidth; col += 2, nextCell++) {
-      
-         // Initialize cell->mask
-         cell = mCells + nextCell;
-         cell->mask = 1 << nextCell;
-
-         cell->loc = CheckersMove::Location(row, col);
-
-         // Initialize mBlackBackRow
-         if (row == 'A') {
-            mBlackBackSet |= cell->mask;
-         }
-         // Initialize mWhiteBackRow
-         else if (row == 'H') {
-            mWhiteBackSet |= cell->mask;
-         } 
-      }
-   }
-
-   // Go back and initialize the directional pointers.  (Can't initialize
-   // in the first pass, since not all cells have been created then).
-   nextCell = 0;
-   for (row = 'A'; row <= 'H'; row ++) {
-      for (col = ((row-'A')%2) + 1; col <= kWidth; col += 2, nextCell++) {
-
-         cell = GetCell(row, col);
-
-         // Set up the directional pointers for mCells.  GetCell() 
-         // automatically returns NULL for any out of bounds values.
-         cell->neighborCells[kSW] = GetCell(row-1, col-1);
-         cell->neighborCells[kSE] = GetCell(row-1, col+1);
-         cell->neighborCells[kNW] = GetCell(row+1, col-1);
-         cell->neighborCells[kNE] = GetCell(row+1,col+1);
-      }
-   }
-}
+MinimaxT<CheckersBoard> CheckersBoard::mMinimax("CheckersBoard");
 
 CheckersBoard::CheckersBoard() : mWhoseMove(kBlack), 
  mBlackPieceCount(kStartingPieces), mBlackKingCount(0), 
  mBlackBackCount(kStartingBackPieces), mWhitePieceCount(kStartingPieces), 
- mWhiteKingCount(0), mWhiteBackCount(kStartingBackPieces) {
+ mWhiteKingCount(0), mWhiteBackCount(kStartingBackPieces),
+ mRules(mDefaultRules) {
    // Just to make sure that I'm covering all my bases with ALL member datum
    assert(mMoveHist.size() == 0);
 
@@ -92,17 +94,15 @@ void CheckersBoard::Delete() {
    mBlackBackCount = mWhiteBackCount = 0;
 
    // Fill up mBlackSet and mWhiteSet
-   for (char row = 'A'; row <= 'H'; row++) {
-      for (unsigned int col = ((row-'A')%2) + 1; col <= kWidth; col += 2) {
-
-         // Fill up initial mBlackSet
-         if (row == 'A' || row == 'B' || row == 'C') {
-            mBlackSet |= GetCell(row, col)->mask;
-         }
-         // Fill up initial mWhiteSet
-         else if (row == 'F' || row == 'G' || row == 'H') {
-            mWhiteSet |= GetCell(row, col)->mask;
-         }
+   for (const Cell *cell = mTables.cells; cell < mTables.cells + kNumCells;
+    cell++) {
+      // Fill up initial mBlackSet
+      if (cell->row == 'A' || cell->row == 'B' || cell->row == 'C') {
+         mBlackSet |= cell->mask;
+      }
+      // Fill up initial mWhiteSet
+      else if (cell->row == 'F' || cell->row == 'G' || cell->row == 'H') {
+         mWhiteSet |= cell->mask;
       }
    }
 
@@ -152,11 +152,11 @@ long CheckersBoard::GetValue() const {
 }
 
 void CheckersBoard::ApplyMove(Move *move) {
-   CheckersMove *castedMove = dynamic_cast<CheckersMove *>(move);
+   CheckersMove *castedMove = static_cast<CheckersMove *>(move);
    CheckersMove::LocVector *locs = &castedMove->mLocs;
    assert(castedMove != NULL && castedMove->mLocs.size() >= 2);
    Set allPieces(mBlackSet | mWhiteSet);
-   Cell *originCell = GetCell((*locs)[0]);
+   const Cell *originCell = GetCell((*locs)[0]);
    int jumpedPieces = 0; // The number of pieces that move "jumps"
    Piece *pieceToMove = NULL;
 
@@ -190,8 +190,9 @@ void CheckersBoard::ApplyMove(Move *move) {
    // logic to remove cells that you've jumped over.
    if (castedMove->mIsJumpMove) {
       for (unsigned int i = 1; i < (*locs).size(); ++i) {
-         Cell *jumpedCell = NULL;
-         Cell *toCell = GetCell((*locs)[i]);
+         const Cell *fromCell = GetCell((*locs)[i-1]);
+         const Cell *toCell = GetCell((*locs)[i]);
+         int dir;
 
          // Assert that this location actually jumps over a piece
          assert(CheckersMove::IsJump((*locs)[i-1], (*locs)[i]));
@@ -205,24 +206,13 @@ void CheckersBoard::ApplyMove(Move *move) {
                assert(i == ((*locs).size() - 1));
          }
 
-         // Figure out which cell you jumped over.
-         // TODO: Refactor this.
-         // North-west jump
-         if ((*locs)[i].first > (*locs)[i-1].first
-          && (*locs)[i].second < (*locs)[i-1].second)
-            jumpedCell = GetCell((*locs)[i].first - 1, (*locs)[i].second + 1);
-         // North-east jump
-         else if ((*locs)[i].first > (*locs)[i-1].first
-          && (*locs)[i].second > (*locs)[i-1].second)
-            jumpedCell = GetCell((*locs)[i].first - 1, (*locs)[i].second - 1);
-         // South-west jump
-         else if ((*locs)[i].first < (*locs)[i-1].first
-          && (*locs)[i].second < (*locs)[i-1].second)
-            jumpedCell = GetCell((*locs)[i].first + 1, (*locs)[i].second + 1);
-         // South-east jump
-         else if ((*locs)[i].first < (*locs)[i-1].first
-          && (*locs)[i].second > (*locs)[i-1].second)
-            jumpedCell = GetCell((*locs)[i].first + 1, (*locs)[i].second - 1);
+         // Figure out which cell you jumped over: the neighbor in the
+         // direction whose jump lands on toCell.
+         for (dir = 0; dir < kSqr && fromCell->jumps[dir] != toCell->mask;
+          dir++)
+            ;
+         assert(dir < kSqr);
+         const Cell *jumpedCell = mTables.cells + fromCell->neighbors[dir];
 
          // TODO: Only use this code if you have a bug and you need to turn
          // on assert statements.
@@ -241,21 +231,24 @@ void CheckersBoard::ApplyMove(Move *move) {
    }
 
    // Add the piece to its final destination
-   Cell *destCell =
-    GetCell((*locs)[locs->size()-1].first, (*locs)[locs->size()-1].second);
+   const Cell *destCell = GetCell((*locs)[locs->size()-1]);
    
-   // If the piece that you're about to Put() is going to be put into the
-   // opponent's back row, then this is a "king me" move.
+   // If the man that you're about to Put() is going to be put into the
+   // opponent's back row, then this is a "king me" move.  (A king arriving
+   // there is not, else undoing its move would demote it.)
    // Set the flags for it, and add this cell to the mKingSet bitmask.
-   if ((mWhoseMove == kBlack && ((destCell->mask & mWhiteBackSet) != 0))
-    || (mWhoseMove == kWhite && ((destCell->mask & mBlackBackSet) != 0))) {
+   if (!pieceToMove->isKing &&
+    ((mWhoseMove == kBlack && ((destCell->mask & mWhiteBackSet) != 0))
+    || (mWhoseMove == kWhite && ((destCell->mask & mBlackBackSet) != 0)))) {
       mKingSet |= destCell->mask;
       castedMove->mIsKingMeMove = true;
       pieceToMove->isKing = true;
    }
 
-   // Add the piece to its final destination.
+   // Add the piece to its final destination.  Put() only marks the cell, so
+   // the Piece from Take() is finished with.
    Put(pieceToMove, destCell);
+   delete pieceToMove;
 
    // Assert that the two bitmasks don't have any pieces in common.
    assert((mBlackSet & mWhiteSet) == 0);
@@ -273,8 +266,8 @@ void CheckersBoard::ApplyMove(Move *move) {
 
 void CheckersBoard::UndoLastMove() {
    // Load up the last move in mMoveHist.
-   CheckersMove *moveToUndo = dynamic_cast<CheckersMove *>(mMoveHist.back());
-   Cell *originCell = GetCell(moveToUndo->mLocs[0]),
+   CheckersMove *moveToUndo = static_cast<CheckersMove *>(mMoveHist.back());
+   const Cell *originCell = GetCell(moveToUndo->mLocs[0]),
     *destCell = GetCell(moveToUndo->mLocs[moveToUndo->mLocs.size()-1]);
    Piece *pieceToMove = NULL;
 
@@ -295,6 +288,7 @@ void CheckersBoard::UndoLastMove() {
    }
 
    Put(pieceToMove, originCell);
+   delete pieceToMove;
    
    // If you're undoing a jump move, then Put each of the moves that you 
    // captured back in.
@@ -304,7 +298,7 @@ void CheckersBoard::UndoLastMove() {
       for (int i = 0; i < numberOfPiecesToPutBack; i++) {
          Piece *pieceToPutBack = mCapturedPieces.back();
          mCapturedPieces.pop_back();
-         Cell *cellToPutItIn = GetCell(pieceToPutBack->loc);
+         const Cell *cellToPutItIn = GetCell(pieceToPutBack->loc);
          Put(pieceToPutBack, cellToPutItIn);
 
          // Delete the Piece object once you put it back into the board.
@@ -323,8 +317,7 @@ void CheckersBoard::UndoLastMove() {
 void CheckersBoard::GetAllMoves(list<Move *> *ucMoves) const {
    list<CheckersMove *> *moves = 
     reinterpret_cast<list<CheckersMove *>*>(ucMoves);
-   char row;
-   unsigned int col;
+   int next, rest;
    bool canJumpAtLeastOnce = false;
 
    assert(ucMoves->size() == 0 && moves->size() == 0);
@@ -334,62 +327,76 @@ void CheckersBoard::GetAllMoves(list<Move *> *ucMoves) const {
     (mWhitePieceCount+mWhiteKingCount) == 0)
       return;
 
-   for (row = 'A'; row <= 'H'; row++) {
-      for (col = ((row-'A')%2) + 1; col <= kWidth; col += 2) {
-         Cell *cell = GetCell(row, col);
-         assert(cell != NULL);
+   // Visit the cells in alphanumeric order, so that moves come out in that
+   // order by starting cell.
+   for (next = 0; next < kNumCells; next++) {
+      const Cell *cell = mTables.cells + mTables.byLoc[next];
+
+      for (int dir = 0; dir < kSqr; dir++) {
+         // If a piece can move in a particular direction, then do it.
+         // It can't possibly jump a piece in that direction.
+         if (!canJumpAtLeastOnce && CanMove(cell, dir)) {
+            // Add a non-jump move in this direction
+            CheckersMove::LocVector locs;
+            locs.push_back(cell->Loc());
+            locs.push_back(mTables.cells[cell->neighbors[dir]].Loc());
+            CheckersMove *newMove = new CheckersMove(locs, false);
+            moves->push_back(newMove);
+         }
+         else if (CanJump(cell, dir)) {
+            // If you can jump any piece, then stop what you're doing,
+            // clear out the non-move pieces that you've collected,
+            // and step through the rest of the board running the DFS
+            // on each Cell.
+            
+            // Clear the board.
+            for (list<CheckersMove *>::iterator listIter = moves->begin();
+             listIter != moves->end(); listIter++) {
+                delete *listIter;
+            }
+            moves->clear();
+
+            // Step through the rest of the board, from the start of
+            // this cell's row.
+            for (rest = next - next % kDim; rest < kNumCells; rest++) {
+               const Cell *newCell = mTables.cells + mTables.byLoc[rest];
 
-         for (int dir = 0; dir < kSqr; dir++) {
-            // If a piece can move in a particular direction, then do it.
-            // It can't possibly jump a piece in that direction.
-            if (!canJumpAtLeastOnce && CanMove(cell, dir)) {
-               // Add a non-jump move in this direction
+               // Add the starting location to any possible jumps, since 
+               // they all would start from this location.
                CheckersMove::LocVector locs;
-               locs.push_back(cell->loc);
-               locs.push_back(cell->neighborCells[dir]->loc);
-               CheckersMove *newMove = new CheckersMove(locs, false);
-               moves->push_back(newMove);
-            }
-            else if (CanJump(cell, dir)) {
-               // If you can jump any piece, then stop what you're doing,
-               // clear out the non-move pieces that you've collected,
-               // and step through the rest of the board running the DFS
-               // on each Cell.
-               
-               // Clear the board.
-               for (list<CheckersMove *>::iterator listIter = moves->begin();
-                listIter != moves->end(); listIter++) {
-                   delete *listIter;
-               }
-               moves->clear();
-
-               // Step through the rest of the board
-               for (char newRow = row; newRow <= 'H'; newRow++) {
-                  for (unsigned int newCol = ((newRow-'A')%2) + 1; 
-                   newCol <= kWidth; newCol += 2) {
-                     Cell *newCell = GetCell(newRow, newCol);
-
-                     // Add the starting location to any possible jumps, since 
-                     // they all would start from this location.
-                     CheckersMove::LocVector locs;
-                     locs.push_back(newCell->loc);
-                     MultipleJumpDFS(moves, locs, newCell);
-                  }
-               }
-
-               // End the method early.
-               return;
+               locs.push_back(newCell->Loc());
+               MultipleJumpDFS(moves, locs, newCell);
             }
+
+            // End the method early.
+            return;
          }
       }
    }
 }
 
+// Jumps are the captures, and are compulsory.  GetAllMoves returns only
+// jumps whenever any jump exists, so its list either is the captures or has 
+// none in it.
+bool CheckersBoard::GetCaptureMoves(list<Move *> *moves) const {
+   list<Move *>::iterator listIter;
+
+   GetAllMoves(moves);
+   if (moves->size() && dynamic_cast<CheckersMove *>(moves->front())
+    ->mIsJumpMove)
+      return true;
+
+   for (listIter = moves->begin(); listIter != moves->end(); listIter++)
+      delete *listIter;
+   moves->clear();
+   return false;
+}
+
 // This method should look for multiple jumps, starting from the cell that you
 // initially jumped into.
 void CheckersBoard::MultipleJumpDFS(list<CheckersMove *> *moves, 
- CheckersMove::LocVector locs, Cell *cell) const {
-   Cell *destCell = NULL;
+ CheckersMove::LocVector locs, const Cell *cell) const {
+   const Cell *destCell = NULL, *overCell = NULL;
    bool foundDeeperJumpBranch = false;
 
    // If moving this to this cell is a "king me" move, then immediately 
@@ -412,19 +419,20 @@ void CheckersBoard::MultipleJumpDFS(list<CheckersMove *> *moves,
       if (CanJump(cell, dir)) {
          // You've found a multiple jump route here.  Set up for your recursive
          // call to keep searching deeper.
-         destCell = cell->neighborCells[dir]->neighborCells[dir];
+         destCell = mTables.cells + cell->landings[dir];
+         overCell = mTables.cells + cell->neighbors[dir];
          foundDeeperJumpBranch = true;
 
          // Temporarily move this piece from the old location to the new 
          // location, and remove the piece that you jumped over.  Undo all of 
          // this after the recursive call.
          Piece *oldLocation = Take(cell, mWhoseMove);
-         Piece *capturedPiece = Take(cell->neighborCells[dir], -mWhoseMove);
+         Piece *capturedPiece = Take(overCell, -mWhoseMove);
          Put(oldLocation, destCell);
 
          // Add the cell that you would jump over into to the LocVector
          // that you're constructing for this [multiple] jump.
-         locs.push_back(destCell->loc);
+         locs.push_back(destCell->Loc());
 
          // Recursive call, using the appended LocVector and the new location
          // that you would jump into.
@@ -437,7 +445,7 @@ void CheckersBoard::MultipleJumpDFS(list<CheckersMove *> *moves,
          // Put the temporary jump back to where it was, and clean up afterwards
          Piece *newLocation = Take(destCell, mWhoseMove);
          delete newLocation;
-         Put(capturedPiece, cell->neighborCells[dir]);
+         Put(capturedPiece, overCell);
          Put(oldLocation, cell);
          delete capturedPiece;
          delete oldLocation;
@@ -453,6 +461,106 @@ void CheckersBoard::MultipleJumpDFS(list<CheckersMove *> *moves,
    }
 }
 
+// Play out on copies of the three Sets, choosing among jumps if there are 
+// any, else among plain moves, as GetAllMoves does.  A player left without
+// a move loses.  A game cut off unfinished is scored as GetValue would
+// score it.
+int CheckersBoard::Playout(XorShift *rng, int maxPlies) {
+   const Cell *cells = mTables.cells;
+   QuickMove moves[kMaxQuickMoves], *move;
+   Set black = mBlackSet, white = mWhiteSet, kings = mKingSet, mine, theirs, 
+    empty, bits;
+   int side = mWhoseMove, plies, numMoves, cell, dir, firstDir, lastDir;
+   long value;
+   bool isKing, canJump;
+
+   for (plies = 0; plies < maxPlies; plies++) {
+      mine = side == kBlack ? black : white;
+      theirs = side == kBlack ? white : black;
+      empty = ~(black | white);
+      numMoves = 0;
+      if (theirs == 0)
+         break;
+
+      for (cell = 0; cell < kNumCells; cell++)
+         if (mine & cells[cell].mask)
+            AddQuickJumps(moves, &numMoves, cells[cell].mask, cells + cell,
+             empty | cells[cell].mask, theirs, 0,
+             (kings & cells[cell].mask) != 0, side);
+
+      // Men move north (kNW, kNE) if black, south (kSW, kSE) if white.
+      for (canJump = numMoves > 0, cell = 0; !canJump && cell < kNumCells;
+       cell++) {
+         if ((mine & cells[cell].mask) == 0)
+            continue;
+         isKing = (kings & cells[cell].mask) != 0;
+         firstDir = isKing || side == kWhite ? kSW : kNW;
+         lastDir = isKing || side == kBlack ? kNE : kSE;
+         for (dir = firstDir; dir <= lastDir; dir++)
+            if (cells[cell].steps[dir] & empty) {
+               moves[numMoves].from = cells[cell].mask;
+               moves[numMoves].to = cells[cell].steps[dir];
+               moves[numMoves++].taken = 0;
+            }
+      }
+      if (numMoves == 0)
+         break;
+
+      move = moves + rng->Below(numMoves);
+      mine ^= move->from | move->to;
+      theirs &= ~move->taken;
+      kings &= ~move->taken;
+      if (kings & move->from)
+         kings ^= move->from | move->to;
+      else if (move->to & (side == kBlack ? mWhiteBackSet : mBlackBackSet))
+         kings |= move->to;
+      black = side == kBlack ? mine : theirs;
+      white = side == kBlack ? theirs : mine;
+      side = -side;
+   }
+
+   if (plies < maxPlies)              // Game over: side to move has lost
+      return side == kBlack ? -1 : 1;
+
+   value = mRules.moveWgt * side;
+   for (bits = black; bits; bits &= bits - 1)
+      value += (bits & kings & -bits ? mRules.kingWgt : pieceWgt)
+       + (bits & mBlackBackSet & -bits ? mRules.backRowWgt : 0);
+   for (bits = white; bits; bits &= bits - 1)
+      value -= (bits & kings & -bits ? mRules.kingWgt : pieceWgt)
+       + (bits & mWhiteBackSet & -bits ? mRules.backRowWgt : 0);
+   return value > 0 ? 1 : value < 0 ? -1 : 0;
+}
+
+void CheckersBoard::AddQuickJumps(QuickMove *moves, int *numMoves, Set from,
+ const Cell *cell, Set empty, Set theirs, Set taken, bool isKing, int side) {
+   int dir, firstDir = isKing || side == kWhite ? kSW : kNW,
+    lastDir = isKing || side == kBlack ? kNE : kSE;
+   bool deeper = false;
+
+   // A man reaching the far row is crowned, ending its move.
+   if (taken && !isKing
+    && (cell->mask & (side == kBlack ? mWhiteBackSet : mBlackBackSet)))
+      dir = lastDir + 1;
+   else
+      dir = firstDir;
+
+   for (; dir <= lastDir; dir++) {
+      if ((cell->steps[dir] & theirs) && (cell->jumps[dir] & empty)) {
+         deeper = true;
+         AddQuickJumps(moves, numMoves, from, mTables.cells
+          + cell->landings[dir], empty | cell->steps[dir],
+          theirs & ~cell->steps[dir], taken | cell->steps[dir], isKing, side);
+      }
+   }
+
+   if (!deeper && taken && *numMoves < kMaxQuickMoves) {
+      moves[*numMoves].from = from;
+      moves[*numMoves].to = cell->mask;
+      moves[(*numMoves)++].taken = taken;
+   }
+}
+
 Board::Move *CheckersBoard::CreateMove() const {
    return new CheckersMove(CheckersMove::LocVector(), false);
 }
@@ -475,25 +583,33 @@ Board *CheckersBoard::Clone() const {
 }
 
 
+// The player to move and the three Sets of kNumCells bits, packed two to a
+// long: 97 bits in all, in two longs.
 Board::Key *CheckersBoard::GetKey() const {
-   BasicKey<4> *rtn = new BasicKey<4>();
+   ulong vals[2];
 
-   rtn->vals[0] = mWhoseMove == kWhite;
-   rtn->vals[1] = mBlackSet;
-   rtn->vals[2] = mWhiteSet;
-   rtn->vals[3] = mKingSet;
+   vals[0] = (ulong)(mWhoseMove == kWhite) << kNumCells | mBlackSet;
+   vals[1] = mWhiteSet << kNumCells | mKingSet;
 
-   return rtn;
+   return new BasicKey<2>(vals);
 }
 
 void *CheckersBoard::GetOptions() {
    // The caller of this method owns the object that is returned here.
-   return new Rules(mRules);
+   return new Rules(mDefaultRules);
 }
 
 void CheckersBoard::SetOptions(const void *opts) {
    // The caller of this method owns the object that is returned here.
-   mRules = *reinterpret_cast<const Rules *>(opts);
+   mDefaultRules = *reinterpret_cast<const Rules *>(opts);
+}
+
+void *CheckersBoard::GetRules() const {
+   return new Rules(mRules);
+}
+
+void CheckersBoard::SetRules(const void *rules) {
+   mRules = *reinterpret_cast<const Rules *>(rules);
 }
 
 istream &CheckersBoard::Read(istream &is) {
@@ -504,16 +620,21 @@ istream &CheckersBoard::Read(istream &is) {
    Delete();
 
    // Read in the Rules that the board should use.
-   is.read((char *)&CheckersBoard::mRules, sizeof(CheckersBoard::mRules));
-   CheckersBoard::mRules.EndSwap();
+   is.read((char *)&mRules, sizeof(mRules));
+   mRules.EndSwap();
 
+   // A short or malformed file leaves the stream failed, and the board
+   // with the moves read whole before that point.
    is.read((char *)&moveCount, sizeof(moveCount));
-   assert(moveCount != -1);  // sanity check to ensure that the read() happened
-   for (int i = 0; i < moveCount; i++) {
+   for (int i = 0; is && i < moveCount; i++) {
       CheckersMove *move = new CheckersMove(CheckersMove::LocVector(), false);
       is >> *move;
 
-      assert(move->mLocs.size() != 0);
+      if (!is || move->mLocs.size() < 2) {
+         is.setstate(ios::failbit);
+         delete move;
+         break;
+      }
 
       ApplyMove(move);
    }
@@ -547,78 +668,66 @@ void CheckersBoard::RefreshBoardValuation() {
    mBlackPieceCount = mWhitePieceCount = mBlackKingCount = mWhiteKingCount
     = mBlackBackCount = mWhiteBackCount = 0;
 
+   assert((mWhiteSet & mBlackSet) == 0);
+
    // Count up the values for each type
-   for (char row = 'A'; row <= 'H'; row ++) {
-      for (unsigned int col = ((row-'A')%2) + 1; col <= kWidth; col += 2) {
-         assert((mWhiteSet & mBlackSet) == 0);
-
-         // If this cell is currently occupied by a Black piece...
-         if (GetCell(row, col)->mask & mBlackSet) {
-            if (GetCell(row, col)->mask & mKingSet)
-               ++mBlackKingCount;
-            else
-               ++mBlackPieceCount;
-
-            if (row == 'A')
-               ++mBlackBackCount;
-         } 
-         // If this cell is currently occupied by a White piece...
-         else if (GetCell(row, col)->mask & mWhiteSet) {
-            if (GetCell(row, col)->mask & mKingSet) 
-               ++mWhiteKingCount;
-            else
-               ++mWhitePieceCount;
-
-            if (row == 'H')
-               ++mWhiteBackCount;
-         }
+   for (const Cell *cell = mTables.cells; cell < mTables.cells + kNumCells;
+    cell++) {
+      // If this cell is currently occupied by a Black piece...
+      if (cell->mask & mBlackSet) {
+         if (cell->mask & mKingSet)
+            ++mBlackKingCount;
+         else
+            ++mBlackPieceCount;
+
+         if (cell->mask & mBlackBackSet)
+            ++mBlackBackCount;
+      } 
+      // If this cell is currently occupied by a White piece...
+      else if (cell->mask & mWhiteSet) {
+         if (cell->mask & mKingSet) 
+            ++mWhiteKingCount;
+         else
+            ++mWhitePieceCount;
+
+         if (cell->mask & mWhiteBackSet)
+            ++mWhiteBackCount;
       }
    }
 }
 
 // TODO: Refactor this to use a Piece instead of a Cell.
-inline bool CheckersBoard::CanMove(Cell *cell, int direction) const {
+inline bool CheckersBoard::CanMove(const Cell *cell, int direction) const {
    // Validate that this piece can move in the direction that you
    // want to move in, and ensure that the piece that you want to move towards 
-   // is inbounds and isn't already occupied.
-   return IsValidDirection(cell, direction) && cell->neighborCells[direction]
-    && !(cell->neighborCells[direction]->mask & (mBlackSet|mWhiteSet));
+   // is inbounds and isn't already occupied.  (An out of bounds step has a 0
+   // mask.)
+   return IsValidDirection(cell, direction)
+    && (cell->steps[direction] & ~(mBlackSet|mWhiteSet));
 }
 
 // TODO: Refactor this to use a Piece instead of a Cell.
-inline bool CheckersBoard::CanJump(Cell *cell, int dir) const {
+inline bool CheckersBoard::CanJump(const Cell *cell, int dir) const {
    // Validate that this piece can move in the direction that you
    // want to move in.
    if (!IsValidDirection(cell, dir))
       return false;
 
-   // Validate that you're actually jumping over a piece (that you're not
-   // trying to jump over a piece that exists out of bounds).
-   if (cell->neighborCells[dir] == NULL)
-      return false;
-
    // Validate that the piece you're jumping over belongs to the other player
-   if ((mWhoseMove == kBlack && 
-         ((cell->neighborCells[dir]->mask & mWhiteSet) == 0))
-      || (mWhoseMove == kWhite &&
-         ((cell->neighborCells[dir]->mask & mBlackSet) == 0))) {
+   // (which it can't if it would be out of bounds, having a 0 mask).
+   if ((cell->steps[dir] & (mWhoseMove == kBlack ? mWhiteSet : mBlackSet))
+    == 0)
       return false;
-   }
       
    // Verify that the spot you want to jump into is inbounds
    // and empty.
-   if (!cell->neighborCells[dir]->neighborCells[dir] ||
-      (cell->neighborCells[dir]->neighborCells[dir]->mask 
-      & (mBlackSet|mWhiteSet)) != 0) {
-         return false;
-   }
-
-   return true;
+   return (cell->jumps[dir] & ~(mBlackSet|mWhiteSet)) != 0;
 }
 
 // Validates that a particular cell is allowed to move in a given direction
 // TODO: Refactor this to use a Piece instead of a Cell.
-inline bool CheckersBoard::IsValidDirection(Cell *cell, int direction) const {
+inline bool CheckersBoard::IsValidDirection(const Cell *cell, int direction)
+ const {
    // Kings can move any direction
    if (mWhoseMove == kBlack && (cell->mask & mBlackSet) != 0 
       && (mKingSet&cell->mask) != 0) {
@@ -640,6 +749,18 @@ inline bool CheckersBoard::IsValidDirection(Cell *cell, int direction) const {
    return false;
 }
 
+void CheckersBoard::SetPosition(ulong black, ulong white, ulong kings,
+ int whoseMove) {
+   assert((black & white) == 0 && (kings & ~(black | white)) == 0);
+
+   Delete();
+   mBlackSet = black;
+   mWhiteSet = white;
+   mKingSet = kings;
+   mWhoseMove = whoseMove;
+   RefreshBoardValuation();
+}
+
 // [Staley] May add a public method for use by CheckersView.
 // Public helper function that returns true if a cell is occupied
 // by a certain color.
@@ -658,7 +779,7 @@ bool CheckersBoard::CellContainsKing(int row, int col) const {
 
 // Helper function to add a piece on the board.
 // ApplyMove() and UndoLastMove() should use Put() instead of this method.
-inline void CheckersBoard::Put(Piece *piece, Cell *cell) const {
+inline void CheckersBoard::Put(Piece *piece, const Cell *cell) const {
    if (piece->color == kBlack) {
       mBlackSet |= cell->mask;
    } else if (piece->color == kWhite) {
@@ -675,7 +796,8 @@ inline void CheckersBoard::Put(Piece *piece, Cell *cell) const {
 // Helper function to remove a piece of a specific color.  
 // Returns the Piece that was removed.
 // ApplyMove() and UndoLastMove() should use Take() instead of this method.
-inline CheckersBoard::Piece *CheckersBoard::Take(Cell *cell, int color) const {     
+inline CheckersBoard::Piece *CheckersBoard::Take(const Cell *cell, int color)
+ const {
    // Assert that the bitmasks don't overlap, so that you can safely
    // clear the mask from BOTH bitmasks.
    assert((mBlackSet & mWhiteSet) == 0);
@@ -689,28 +811,5 @@ inline CheckersBoard::Piece *CheckersBoard::Take(Cell *cell, int color) const {
    // Remove the cell from mKingSet before you finish
    mKingSet &= ~(cell->mask);
 
-   return new Piece(wasKing, color, cell->loc);
+   return new Piece(wasKing, color, cell->Loc());
 }
-
-// Returns NULL if parameters are invalid
-inline CheckersBoard::Cell *CheckersBoard::GetCell(char row, unsigned col) {
-   // Out of bounds
-   if (row < 'A' || row > 'H' || col < 1 || col > 8) {
-      return NULL;
-   }
-
-   // Reduce the inputted characters to their numerical form
-   // (I drew up a diagram of this in my binder)
-   row -= 'A';
-   col -= 1;
-
-   row = kWidth - row - 1;
-      
-   // Invalid square.  Row and Col must either be odd/even or even/odd,
-   // respectively.
-   if (!((IsEven(row) && IsOdd(col)) || (IsOdd(row) && IsEven(col)))) {
-      return NULL;
-   }
-
-   return mCells + (row*kDim) + (col/2);
-}
\ No newline at end of file
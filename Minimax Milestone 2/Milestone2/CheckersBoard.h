@@ -6,10 +6,12 @@
 #include "MyLib.h"
 
 class CheckersMove;
+template <class B> class MinimaxT;
 
-class CheckersBoard : public Board {
+class CheckersBoard final : public Board {
 public:
    friend class CheckersMove;
+   friend class CheckersTablebase;
 
    // Game logic relies on kWhite being -1 and kBlack being 1
    // kHeight is equal to vertical height of the board, measured in Cells.
@@ -32,6 +34,8 @@ public:
    void ApplyMove(Move *);
    void UndoLastMove();
    void GetAllMoves(std::list<Move *> *) const;
+   bool GetCaptureMoves(std::list<Move *> *) const;
+   int Playout(XorShift *rng, int maxPlies);
    Move *CreateMove() const;
    int GetWhoseMove() const {return mWhoseMove == kWhite;}
    const std::list<const Move *> &GetMoveHist() const 
@@ -39,20 +43,23 @@ public:
 
    Board *Clone() const;
    Key *GetKey() const;
+   void *GetRules() const;
+   void SetRules(const void *rules);
 
    bool CellOccupied(int row, int col, int byWhom) const;
    bool CellContainsKing(int row, int col) const;
 
-   // Option accessor/mutator.  GetOptions returns dynamically allocated
-   // object representing options. SetOptions takes similar object.  Caller
-   // owns object in both cases.
+   // Replace the position with the given bitmasks of black, white and king
+   // cells (laid out as mBlackSet etc. are), with 'whoseMove' (kBlack or 
+   // kWhite) to move.  The move history is cleared.
+   void SetPosition(ulong black, ulong white, ulong kings, int whoseMove);
+
+   // Option accessor/mutator for the default Rules copied by new boards.
+   // GetOptions returns dynamically allocated object representing options.
+   // SetOptions takes similar object.  Caller owns object in both cases.
    static void *GetOptions();
    static void SetOptions(const void *opts);
 
-   // Arrange for this to be called at static initialization time, to set up
-   // the static mWhiteBackRow and mBlackBackRow
-   static void StaticInit();
-
    int mWhoseMove; // Whose move it is.  Can be kBlack or kWhite.
 
    const Class *GetClass() const { return &mClass; };
@@ -61,17 +68,32 @@ protected:
    
    enum { kStartingPieces = 12, kStartingBackPieces = 4, kSqr = 4 };
    enum { kSW = 0, kSE = 1, kNW = 2, kNE = 3 };
+   enum { kNoCell = -1 };
 
    typedef ulong Set;
 
    // Struct that defines static cells of the CheckersBoard.  Don't change this.
+   // Neighbors are given both as masks and as indices into mTables.cells,
+   // per direction.  A direction leading off the board has a 0 mask and
+   // kNoCell, so a mask test alone tells whether a step or jump is open.
    struct Cell {
-      Set mask; // Mask with this cell's bit turned on
-
-      Cell *neighborCells[kSqr];
+      Set mask;              // Mask with this cell's bit turned on
+      Set steps[kSqr];       // Mask of the adjacent cell
+      Set jumps[kSqr];       // Mask of the cell a jump lands on
+      char neighbors[kSqr];  // Adjacent cell
+      char landings[kSqr];   // Cell a jump lands on
+      char row;              // Location, as 'A' - 'H'
+      char col;              // and 1 - 8
+
+      std::pair<char, unsigned int> Loc() const
+       {return std::pair<char, unsigned int>(row, col);}
+   };
 
-      // std::string name;  // Formatted name of this Cell
-      std::pair<char, unsigned int> loc;
+   // All the static cell data, built at compile time by MakeTables.
+   struct Tables {
+      Cell cells[kNumCells];        // One Cell for each cell
+      char cellAt[kWidth][kWidth];  // Cell by row and col from 0, or kNoCell
+      char byLoc[kNumCells];        // Cells in alphanumeric order, A1 first
    };
 
    // Struct that defines non-static Checkers pieces being played on top
@@ -85,44 +107,62 @@ protected:
          isKing(isKing), color(color), loc(loc) {}
    };
 
+   // A move as Playout keeps it: masks of the cell the piece leaves, the
+   // cell it reaches, and the cells of any pieces it captures.
+   struct QuickMove {
+      Set from, to, taken;
+   };
+   enum {kMaxQuickMoves = 64};
+
    std::istream &Read(std::istream &);
    std::ostream &Write(std::ostream &) const;
 
    // Frees all CheckersBoard storage.
    void Delete();
    
-   inline void Put(Piece *piece, Cell *cell) const;
-   inline Piece *Take(Cell *cell, int color) const;
+   inline void Put(Piece *piece, const Cell *cell) const;
+   inline Piece *Take(const Cell *cell, int color) const;
 
    void RefreshBoardValuation();
 
    void MultipleJumpDFS(std::list<CheckersMove *> *, 
-    std::vector<std::pair<char, unsigned int> >, Cell *) const;
-
-   inline bool CanMove(Cell *cell, int direction) const;
-   inline bool CanJump(Cell *cell, int dir) const;
-   inline bool IsValidDirection(Cell *cell, int direction) const;
-   
-   // Quick helper functions for GetCell()
-   static inline bool IsEven(char num) { return num % 2; }
-   static inline bool IsOdd(char num) { return !IsEven(num); }
-
-   static inline Cell *GetCell(char row, unsigned col);
-   static inline Cell *GetCell(const std::pair<char, unsigned int> &loc) {
+    std::vector<std::pair<char, unsigned int> >, const Cell *) const;
+
+   // Add to moves[*numMoves] the jumps by the piece that left 'from' and
+   // has reached 'cell', having captured 'taken' so far, as MultipleJumpDFS
+   // would find them.
+   static void AddQuickJumps(QuickMove *moves, int *numMoves, Set from,
+    const Cell *cell, Set empty, Set theirs, Set taken, bool isKing,
+    int side);
+
+   inline bool CanMove(const Cell *cell, int direction) const;
+   inline bool CanJump(const Cell *cell, int dir) const;
+   inline bool IsValidDirection(const Cell *cell, int direction) const;
+
+   // Return the Cell at row, col, or NULL if that's off the board or not a
+   // playing square.
+   static inline const Cell *GetCell(char row, unsigned col) {
+      return InRange<char>('A', row, 'A' + kWidth)
+       && InRange<unsigned>(1, col, kWidth + 1)
+       && mTables.cellAt[row - 'A'][col - 1] != kNoCell
+       ? mTables.cells + mTables.cellAt[row - 'A'][col - 1] : NULL;
+   }
+   static inline const Cell *GetCell(const std::pair<char, unsigned int> &loc) {
       return GetCell(loc.first, loc.second);
    }
 
+   // Build mTables.
+   static constexpr Tables MakeTables();
+
    // Static member datum goes here
-   struct CheckersBoardInitializer {
-      CheckersBoardInitializer() { CheckersBoard::StaticInit(); }
-   };
-   static CheckersBoardInitializer mInitializer;
+   static Rules mDefaultRules; // Rules copied by each new CheckersBoard
 
-   static Rules mRules; // The static rules object for CheckersBoard
+   static const Tables mTables;
 
-   static Cell mCells[kNumCells]; // One Cell for each cell
-   static Set mBlackBackSet; // Static bitmask of the cells of Black's back row
-   static Set mWhiteBackSet; // Static bitmask of the cells of White's back row
+   // Static bitmask of the cells of White's back row (row H, cells 0 - 3),
+   // and of Black's (row A, the last kDim cells).
+   static constexpr Set mWhiteBackSet = (1UL << kDim) - 1;
+   static constexpr Set mBlackBackSet = mWhiteBackSet << (kNumCells - kDim);
 
    // Bitmasks indicating which cells contain white pieces, black pieces,
    // and Kings.  No-marble cells are 0 in both masks.  Bits are assigned to
@@ -133,11 +173,14 @@ protected:
    int mBlackPieceCount, mBlackKingCount, mBlackBackCount, mWhitePieceCount,
     mWhiteKingCount, mWhiteBackCount; 
 
+   Rules mRules; // Weights this board's GetValue uses
+
    std::list<Move *> mMoveHist; // History of moves thus far.
    std::list<Piece *> mCapturedPieces; // Stack of pieces captured.
    
    static Object *CreateCheckersBoard() { return new CheckersBoard; };
    static BoardClass mClass;
+   static MinimaxT<CheckersBoard> mMinimax;  // Search compiled for this class
 
 };
 
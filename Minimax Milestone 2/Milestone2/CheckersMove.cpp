@@ -1,4 +1,6 @@
 #include "MyLib.h"
+#include "Arena.h"
+#include "SlabPool.h"
 #include "CheckersMove.h"
 #include <cctype>
 #include <assert.h>
@@ -6,27 +8,24 @@
 
 using namespace std;
 
-vector<CheckersMove *> CheckersMove::mFreeList;
 static const int kUpperLimit = 9;
 
+// Allocate from the current search's Arena, if any, or else the pool.
 void *CheckersMove::operator new(size_t sz) {
-   void *temp;
+   void *temp = Arena::AllocCurrent(sz);
 
-   if (mFreeList.size()) {
-      temp = mFreeList.back();
-      mFreeList.pop_back();
-   } else {
-      temp = ::new char[sz];
-   }
+   if (!temp)
+      temp = SlabPool<CheckersMove>::Alloc();
 
-   mOutstanding++;
+   MemStats::Alloc(MemStats::kMove, sizeof(CheckersMove));
    return temp;
 }
 
 void CheckersMove::operator delete(void *p) {
-   mFreeList.push_back((CheckersMove *)p);
+   if (!Arena::FreeCurrent(p, sizeof(CheckersMove)))
+      SlabPool<CheckersMove>::Free(p);
 
-   mOutstanding--;
+   MemStats::Free(MemStats::kMove, sizeof(CheckersMove));
 }
 
 bool CheckersMove::operator==(const Board::Move &rhs) const {
@@ -147,6 +146,51 @@ void CheckersMove::operator=(const string &src) {
       mIsJumpMove = false;
 }
 
+uint CheckersMove::GetCode() const {
+   uint code = 0, hops = mLocs.size() - 1, ndx, shift;
+   int step = mIsJumpMove ? 2 : 1;
+
+   assert(mLocs.size() > 1 && hops <= kMaxHops);
+   code = (mLocs[0].first - 'A') | (mLocs[0].second - 1) << kLocBits
+    | mIsJumpMove << 2 * kLocBits | hops << (2 * kLocBits + 1);
+
+   shift = 2 * kLocBits + 1 + kCountBits;
+   for (ndx = 1; ndx <= hops; ndx++, shift += kHopBits)
+      code |= (mLocs[ndx].first - mLocs[ndx-1].first == step) << shift
+       | ((int)mLocs[ndx].second - (int)mLocs[ndx-1].second == step)
+       << (shift + 1);
+
+   return code;
+}
+
+void CheckersMove::SetCode(uint code) {
+   uint hops = code >> (2 * kLocBits + 1) & ((1 << kCountBits) - 1), ndx;
+   uint shift = 2 * kLocBits + 1 + kCountBits;
+   bool isJump = code >> 2 * kLocBits & 1;
+   int step = isJump ? 2 : 1;
+   LocVector locs(hops + 1);
+
+   if (hops < 1 || hops > kMaxHops || (!isJump && hops > 1)
+    || code >> (shift + hops * kHopBits))
+      throw BaseException(FString("Bad Checkers move code: %X", code));
+
+   locs[0].first = 'A' + (code & ((1 << kLocBits) - 1));
+   locs[0].second = 1 + (code >> kLocBits & ((1 << kLocBits) - 1));
+   for (ndx = 1; ndx <= hops; ndx++, shift += kHopBits) {
+      locs[ndx].first = locs[ndx-1].first
+       + (code >> shift & 1 ? step : -step);
+      locs[ndx].second = locs[ndx-1].second
+       + (code >> (shift + 1) & 1 ? step : -step);
+      if (!InRange<char>('A', locs[ndx].first, 'I')
+       || !InRange<unsigned int>(1, locs[ndx].second, kUpperLimit))
+         throw BaseException(FString("Bad Checkers move code: %X", code));
+   }
+
+   mLocs = locs;
+   mIsJumpMove = isJump;
+   mIsKingMeMove = false;
+}
+
 Board::Move *CheckersMove::Clone() const {
    return new CheckersMove(this->mLocs, mIsJumpMove);
 }
@@ -189,7 +233,10 @@ istream &CheckersMove::Read(istream &is) {
 
    // Read in mLocs's size and mLocs itself
    is.read((char *)&mLocsSize, sizeof(mLocsSize));
-   assert(mLocsSize != -1);  // sanity check to ensure mLocsSize was read().
+   if (!is || mLocsSize < 0) {
+      is.setstate(ios::failbit);
+      return is;
+   }
    mLocs.resize(mLocsSize);
    for (i = 0; i < mLocsSize; ++i) {
 
@@ -5,7 +5,9 @@
 #include <cstdlib>
 #include "Board.h"
 
-class CheckersMove : public Board::Move {
+class CheckersBoard;
+
+class CheckersMove final : public Board::Move {
 public:
    typedef std::pair<char, unsigned int> Location;
    typedef std::vector<Location> LocVector;
@@ -20,12 +22,20 @@ public:
    bool operator<(const Board::Move &rhs) const;
    operator std::string() const;
    void operator=(const std::string &src);
+   uint GetCode() const;
+   void SetCode(uint code);
    Board::Move *Clone() const;
    
    void operator delete(void *p);
    void *operator new(size_t sz);
 
 protected:
+   // A code holds the starting row and column (from 0) in kLocBits each,
+   // a jump flag, the number of hops in kCountBits, and then for each hop
+   // a row bit (set for a hop toward row H) and a column bit (set for a hop
+   // toward column 8).  Each hop moves one square, or two for a jump.
+   enum {kLocBits = 3, kCountBits = 4, kHopBits = 2,
+    kMaxHops = (32 - 2 * kLocBits - 1 - kCountBits) / kHopBits};
 
    std::istream &Read(std::istream &is);
    std::ostream &Write(std::ostream &) const;
@@ -33,7 +43,6 @@ protected:
    LocVector mLocs;
    bool mIsJumpMove, mIsKingMeMove;
 
-   static std::vector<CheckersMove *> mFreeList;
 
    inline void CastToUpperAndVerify(Location *loc, std::string src);
 
@@ -44,4 +53,8 @@ protected:
 
 };
 
-#endif
\ No newline at end of file
+template <> struct GameTraits<CheckersBoard> {
+   typedef CheckersMove Move;
+};
+
+#endif
@@ -0,0 +1,522 @@
+#include <assert.h>
+#include <string.h>
+#include <fstream>
+#include <vector>
+#include <list>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "CheckersTablebase.h"
+#include "CheckersBoard.h"
+
+using namespace std;
+
+// Files of the older win/loss/draw format began "CKTB", so Load refuses them.
+static const char kMagic[] = "CKTD";
+
+ulong CheckersTablebase::mBinomials[kNumCells + 1][kMaxPieces + 1];
+
+CheckersTablebase CheckersTablebase::mBase;
+
+CheckersTablebase::CheckersTablebase() : EndgameSolver("CheckersBoard"),
+ mMaxPieces(0), mFile(NULL), mFileSize(0), mMapped(false) {
+   int cells, pieces;
+
+   for (cells = 0; cells <= kNumCells; cells++)
+      for (pieces = 0; pieces <= kMaxPieces; pieces++)
+         mBinomials[cells][pieces] = pieces == 0 ? 1 : cells == 0 ? 0 :
+          mBinomials[cells-1][pieces-1] + mBinomials[cells-1][pieces];
+}
+
+CheckersTablebase::~CheckersTablebase() {
+   Unload();
+}
+
+// Number of indices in the slice for 'pieces' pieces: one per set of occupied
+// cells, per 2-bit code for each piece, per side to move.
+ulong CheckersTablebase::GetSliceSize(int pieces) {
+   return mBinomials[kNumCells][pieces] << 2 * pieces << 1;
+}
+
+// Return the index of the given position within its slice, and its number of
+// pieces in *pieces.  The occupied cells c1 < c2 < ... < cn are ranked as
+// C(c1, 1) + C(c2, 2) + ... + C(cn, n).  The rank varies fastest, and the
+// side to move slowest, since neighboring boards then tend to share results,
+// which makes for longer runs.
+ulong CheckersTablebase::GetIndex(Set black, Set white, Set kings,
+ bool whiteMoves, int *pieces) {
+   ulong rank = 0, codes = 0;
+   int cell, count = 0;
+
+   for (cell = 0; cell < kNumCells; cell++)
+      if ((black | white) >> cell & 1) {
+         rank += mBinomials[cell][++count];
+         codes = codes << 2 | (white >> cell & 1) | (kings >> cell & 1) << 1;
+      }
+
+   *pieces = count;
+   return (((ulong)whiteMoves << 2 * count | codes) 
+    * mBinomials[kNumCells][count]) + rank;
+}
+
+// Inverse of GetIndex, for a slice of 'pieces' pieces.
+void CheckersTablebase::GetPosition(int pieces, ulong index, Set *black,
+ Set *white, Set *kings, bool *whiteMoves) {
+   ulong rank = index % mBinomials[kNumCells][pieces],
+    codes = index / mBinomials[kNumCells][pieces];
+   int cell = kNumCells - 1, count, code;
+
+   *black = *white = *kings = 0;
+   *whiteMoves = codes >> 2 * pieces & 1;
+   for (count = pieces; count > 0; count--) {
+      while (mBinomials[cell][count] > rank)
+         cell--;
+      rank -= mBinomials[cell][count];
+
+      code = codes >> 2 * (pieces - count) & 0x3;
+      if (code & 1)
+         *white |= 1UL << cell;
+      else
+         *black |= 1UL << cell;
+      if (code & 2)
+         *kings |= 1UL << cell;
+   }
+}
+
+// Both sides must have pieces, and no man may stand on the row that would
+// have crowned it.
+bool CheckersTablebase::IsValid(Set black, Set white, Set kings) {
+   return black && white && !(black & ~kings & CheckersBoard::mWhiteBackSet)
+    && !(white & ~kings & CheckersBoard::mBlackBackSet);
+}
+
+// Solve each slice in turn, smallest first, so that every capture leads to
+// a board already solved.  A first pass over the slice settles boards whose
+// moves all leave the slice (captures, which are forced when there are any),
+// or that have no moves, and caches the in-slice successors of the rest.
+// Pass d then settles the boards d halfmoves from the end: a board is won if
+// some successor was settled as lost d - 1 halfmoves from the end, and lost
+// if every successor was settled as won, the farthest d - 1 from the end.
+// Passes go on until one settles nothing and no distance from outside the
+// slice is still to come.  Whatever is still unsettled can never be forced
+// either way, so is drawn.
+void CheckersTablebase::Generate(int maxPieces, ostream &os, ostream *log) {
+   struct Pending {
+      uint index;       // Index of unsettled board
+      uint first;       // Its first successor in 'succs'
+      uint count;       // Number of successors in this slice
+      unsigned char winDist;   // Distance won through a capture, or 0
+      unsigned char lossDist;  // Greatest distance lost through a capture
+      bool canLose;            // All successors outside the slice are won
+   };
+
+   CheckersBoard board;
+   vector<unsigned char> entries[kMaxPieces + 1];
+   vector<Pending> pending;
+   vector<uint> succs;
+   list<Board::Move *> moves;
+   list<Board::Move *>::iterator mIter;
+   Set black, white, kings;
+   ulong size, index, succIndex, ndx, wins, losses, draws;
+   int pieces, succPieces, entry, succEntry, dist, horizon, longest, val;
+   bool whiteMoves, changed, canLose;
+   Pending *pnd, *kept;
+
+   assert(kMinPieces <= maxPieces && maxPieces <= kMaxPieces);
+   os.write(kMagic, sizeof(kMagic) - 1);
+   val = EndianXfer(maxPieces);
+   os.write((char *)&val, sizeof(val));
+
+   for (pieces = kMinPieces; pieces <= maxPieces; pieces++) {
+      size = GetSliceSize(pieces);
+      entries[pieces].assign(size, kInvalid);
+      pending.clear();
+      succs.clear();
+      horizon = 0;
+
+      for (index = 0; index < size; index++) {
+         GetPosition(pieces, index, &black, &white, &kings, &whiteMoves);
+         if (!IsValid(black, white, kings))
+            continue;
+
+         board.SetPosition(black, white, kings, whiteMoves ?
+          CheckersBoard::kWhite : CheckersBoard::kBlack);
+         board.GetAllMoves(&moves);
+
+         Pending next = {(uint)index, (uint)succs.size(), 0, 0, 0, true};
+         for (mIter = moves.begin(); mIter != moves.end(); mIter++) {
+            board.ApplyMove(*mIter);
+            succEntry = kInvalid;
+            if (!board.mBlackSet || !board.mWhiteSet)
+               succEntry = kDecided;
+            else {
+               succIndex = GetIndex(board.mBlackSet, board.mWhiteSet,
+                board.mKingSet, !whiteMoves, &succPieces);
+               if (succPieces == pieces) {
+                  succs.push_back((uint)succIndex);
+                  next.count++;
+               }
+               else
+                  succEntry = entries[succPieces][succIndex];
+            }
+            board.UndoLastMove();
+
+            dist = succEntry - kDecided + 1;
+            if (IsLoss(succEntry))
+               next.winDist = next.winDist ? TMin<int>(next.winDist, dist)
+                : dist;
+            else if (IsWin(succEntry))
+               next.lossDist = TMax<int>(next.lossDist, dist);
+            else if (succEntry == kDraw)
+               next.canLose = false;
+         }
+
+         if (moves.empty())
+            entry = kDecided;
+         else if (next.count)
+            entry = kInvalid;
+         else if (next.winDist)
+            entry = kDecided + next.winDist;
+         else
+            entry = next.canLose ? kDecided + next.lossDist : kDraw;
+         moves.clear();
+
+         if (entry != kInvalid)
+            succs.resize(next.first);
+         else {
+            pending.push_back(next);
+            horizon = TMax<int>(horizon, TMax(next.winDist, next.lossDist));
+         }
+         entries[pieces][index] = entry;
+      }
+
+      for (dist = 1, changed = true; !pending.empty()
+       && (changed || dist <= horizon); dist++) {
+         changed = false;
+         for (pnd = pending.data(); pnd < pending.data() + pending.size();
+          pnd++) {
+            entry = pnd->winDist == dist ? kDecided + dist : kInvalid;
+            canLose = pnd->canLose;
+            longest = pnd->lossDist;
+            for (ndx = pnd->first; entry == kInvalid
+             && ndx < pnd->first + pnd->count; ndx++) {
+               succEntry = entries[pieces][succs[ndx]];
+               if (IsLoss(succEntry) && succEntry - kDecided == dist - 1)
+                  entry = kDecided + dist;
+               else if (IsWin(succEntry) && succEntry - kDecided < dist)
+                  longest = TMax(longest, succEntry - kDecided + 1);
+               else
+                  canLose = false;
+            }
+            if (entry == kInvalid && canLose && longest <= dist)
+               entry = kDecided + dist;
+
+            if (entry != kInvalid) {
+               assert(dist <= kMaxDistance);
+               entries[pieces][pnd->index] = entry;
+               changed = true;
+            }
+         }
+
+         // Drop the boards just settled, so later passes skip them.
+         for (pnd = kept = pending.data(); pnd < pending.data()
+          + pending.size(); pnd++)
+            if (entries[pieces][pnd->index] == kInvalid)
+               *kept++ = *pnd;
+         pending.resize(kept - pending.data());
+      }
+
+      for (pnd = pending.data(); pnd < pending.data() + pending.size(); pnd++)
+         entries[pieces][pnd->index] = kDraw;
+
+      WriteSlice(os, entries[pieces].data(), size);
+
+      if (log) {
+         wins = losses = draws = longest = 0;
+         for (index = 0; index < size; index++) {
+            entry = entries[pieces][index];
+            wins += IsWin(entry);
+            losses += IsLoss(entry);
+            draws += entry == kDraw;
+            if (entry >= kDecided)
+               longest = TMax(longest, entry - kDecided);
+         }
+         *log << pieces << " pieces: " << wins << " wins, " << losses
+          << " losses, " << draws << " draws, " << size - wins - losses
+          - draws << " invalid, longest " << longest << " halfmoves" << endl;
+      }
+   }
+}
+
+// Write the slice size, block count, block offsets and blocks for
+// 'numEntries' entries.  The blocks are padded to a 4-byte boundary so the
+// next slice's header is aligned.
+void CheckersTablebase::WriteSlice(ostream &os, const unsigned char *entries,
+ ulong numEntries) {
+   vector<unsigned char> data;
+   vector<uint> offsets;
+   ulong start, end, ndx, run, lit;
+   uint val;
+
+   for (start = 0; start < numEntries; start += kBlockSize) {
+      offsets.push_back(EndianXfer((uint)data.size()));
+      end = TMin<ulong>(start + kBlockSize, numEntries);
+      for (ndx = start, lit = 0; ndx <= end; ndx += run) {
+         for (run = 1; ndx + run < end && run < kMaxRun
+          && entries[ndx + run] == entries[ndx]; run++)
+            ;
+
+         // Write the literals gathered so far before a run, at the block's
+         // end, or when there are as many as a count byte can hold.
+         if (lit && (run >= kMinRun || ndx == end || lit == kMaxRun)) {
+            data.push_back(lit - 1);
+            data.insert(data.end(), entries + ndx - lit, entries + ndx);
+            lit = 0;
+         }
+         if (ndx == end)
+            break;
+
+         if (run >= kMinRun) {
+            data.push_back(kRunFlag | (run - 1));
+            data.push_back(entries[ndx]);
+         }
+         else {
+            run = 1;
+            lit++;
+         }
+      }
+   }
+   while (data.size() % sizeof(uint))
+      data.push_back(0);
+   offsets.push_back(EndianXfer((uint)data.size()));
+
+   val = EndianXfer((uint)numEntries);
+   os.write((char *)&val, sizeof(val));
+   val = EndianXfer((uint)offsets.size() - 1);
+   os.write((char *)&val, sizeof(val));
+   os.write((char *)offsets.data(), offsets.size() * sizeof(uint));
+   os.write((char *)data.data(), data.size());
+}
+
+bool CheckersTablebase::Load(const string &path) {
+   const char *cursor, *end;
+   int pieces, maxPieces;
+   uint numBlocks;
+
+   Unload();
+
+#ifdef _WIN32
+   ifstream in(path.c_str(), ios::binary);
+
+   if (!in || !in.seekg(0, ios::end))
+      return false;
+   mFileSize = (ulong)in.tellg();
+   mFile = new char[mFileSize];
+   in.seekg(0).read(mFile, mFileSize);
+   if (!in) {
+      Unload();
+      return false;
+   }
+#else
+   struct stat info;
+   void *map;
+   int fd = open(path.c_str(), O_RDONLY);
+
+   if (fd < 0)
+      return false;
+   map = fstat(fd, &info) == 0 && info.st_size > 0 ?
+    mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+   close(fd);
+   if (map == MAP_FAILED)
+      return false;
+
+   mFile = (char *)map;
+   mFileSize = info.st_size;
+   mMapped = true;
+#endif
+
+   cursor = mFile;
+   end = mFile + mFileSize;
+   if (mFileSize < sizeof(kMagic) - 1 + sizeof(int)
+    || memcmp(cursor, kMagic, sizeof(kMagic) - 1) != 0) {
+      Unload();
+      return false;
+   }
+   cursor += sizeof(kMagic) - 1;
+   maxPieces = EndianXfer(*(const int *)cursor);
+   cursor += sizeof(int);
+
+   for (pieces = kMinPieces; pieces <= maxPieces && pieces <= kMaxPieces;
+    pieces++) {
+      if (end - cursor < 2 * (long)sizeof(uint))
+         break;
+      mSlices[pieces].numEntries = EndianXfer(*(const uint *)cursor);
+      numBlocks = EndianXfer(*(const uint *)(cursor + sizeof(uint)));
+      mSlices[pieces].offsets = (const uint *)(cursor + 2 * sizeof(uint));
+      mSlices[pieces].data =
+       (const unsigned char *)(mSlices[pieces].offsets + numBlocks + 1);
+      if ((const char *)mSlices[pieces].data > end || mSlices[pieces].numEntries
+       != GetSliceSize(pieces))
+         break;
+      cursor = (const char *)mSlices[pieces].data
+       + EndianXfer(mSlices[pieces].offsets[numBlocks]);
+      if (cursor > end)
+         break;
+   }
+
+   if (pieces <= maxPieces) {
+      Unload();
+      return false;
+   }
+   mMaxPieces = maxPieces;
+   return true;
+}
+
+void CheckersTablebase::Unload() {
+   if (mFile) {
+#ifndef _WIN32
+      if (mMapped)
+         munmap(mFile, mFileSize);
+      else
+#endif
+         delete[] mFile;
+   }
+   mFile = NULL;
+   mFileSize = 0;
+   mMapped = false;
+   mMaxPieces = 0;
+}
+
+// Return the entry for the given position, or kInvalid if the loaded
+// database doesn't cover it.
+int CheckersTablebase::Lookup(Set black, Set white, Set kings,
+ bool whiteMoves) const {
+   const unsigned char *cursor;
+   ulong index, pos, run;
+   int pieces;
+
+   index = GetIndex(black, white, kings, whiteMoves, &pieces);
+   if (pieces < kMinPieces || pieces > mMaxPieces)
+      return kInvalid;
+
+   const Slice &slice = mSlices[pieces];
+   cursor = slice.data + EndianXfer(slice.offsets[index / kBlockSize]);
+   for (pos = index % kBlockSize; ; pos -= run) {
+      run = (*cursor & ~kRunFlag) + 1;
+      if (pos < run)
+         return *cursor & kRunFlag ? cursor[1] : cursor[1 + pos];
+      cursor += *cursor & kRunFlag ? 2 : 1 + run;
+   }
+}
+
+// Return the entry for *brd, as Lookup does, but taking a board whose side
+// to move has no pieces left as lost then and there.
+int CheckersTablebase::GetEntry(const Board *brd) const {
+   const CheckersBoard *cb = dynamic_cast<const CheckersBoard *>(brd);
+   bool whiteMoves = cb->mWhoseMove == CheckersBoard::kWhite;
+
+   if (mMaxPieces == 0)
+      return kInvalid;
+   if (!(whiteMoves ? cb->mWhiteSet : cb->mBlackSet))
+      return kDecided;
+   if (!IsValid(cb->mBlackSet, cb->mWhiteSet, cb->mKingSet))
+      return kInvalid;
+   return Lookup(cb->mBlackSet, cb->mWhiteSet, cb->mKingSet, whiteMoves);
+}
+
+// Rank the entry of a board just moved to, from the view of the side that
+// moved: any win above any draw above any loss, quicker wins above slower
+// ones, and slower losses above quicker ones.
+int CheckersTablebase::GetRank(int entry) {
+   if (entry == kInvalid)
+      return -1;
+   if (entry == kDraw)
+      return kMaxDistance + 1;
+   return IsWin(entry) ? entry - kDecided
+    : 2 * kMaxDistance + 2 - (entry - kDecided);
+}
+
+int CheckersTablebase::GetRemaining(const Board *brd) const {
+   const CheckersBoard *cb = dynamic_cast<const CheckersBoard *>(brd);
+   Set all = cb->mBlackSet | cb->mWhiteSet;
+   int pieces = 0;
+
+   for (; all; all &= all - 1)
+      pieces++;
+
+   return pieces <= mMaxPieces ? pieces : kNumCells + 1;
+}
+
+bool CheckersTablebase::Probe(const Board *brd, long *value) const {
+   const CheckersBoard *cb = dynamic_cast<const CheckersBoard *>(brd);
+   int entry;
+
+   if (mMaxPieces == 0 || !IsValid(cb->mBlackSet, cb->mWhiteSet, cb->mKingSet))
+      return false;
+
+   entry = Lookup(cb->mBlackSet, cb->mWhiteSet, cb->mKingSet,
+    cb->mWhoseMove == CheckersBoard::kWhite);
+   if (entry == kInvalid)
+      return false;
+
+   *value = entry == kDraw ? 0 : IsWin(entry) == (brd->GetWhoseMove() == 0)
+    ? Board::kWinVal : -Board::kWinVal;
+   return true;
+}
+
+// Pick the move, and the reply to it, that end a won game soonest, put off
+// the end of a lost one longest, or keep a draw.  The score returned ranks
+// wins by the same distance: a win in fewer halfmoves scores higher.
+long CheckersTablebase::Solve(Board *brd, BestMove *res) const {
+   Board::Move *move, *reply;
+   int entry = GetEntry(brd);
+
+   res->Clear(GetRemaining(brd), 1);
+   if (!Probe(brd, &res->value))
+      res->value = brd->GetValue();
+
+   if ((move = PickMove(brd, &res->numBoards))) {
+      res->move = move->GetCode();
+      brd->ApplyMove(move);
+      if ((reply = PickMove(brd, &res->numBoards))) {
+         res->replyMove = reply->GetCode();
+         delete reply;
+      }
+      brd->UndoLastMove();
+   }
+
+   if (entry < kDecided)
+      return res->value;
+   return res->value > 0 ? res->value - (entry - kDecided)
+    : res->value + (entry - kDecided);
+}
+
+// Return the move from *brd to the board that GetRank ranks highest, or
+// NULL if there is none.  Caller owns the move.  Adds the number of boards
+// examined to *numBoards.
+Board::Move *CheckersTablebase::PickMove(Board *brd, long *numBoards) const {
+   list<Board::Move *> moves;
+   list<Board::Move *>::iterator mIter;
+   Board::Move *pick = NULL;
+   int rank, bestRank = -1;
+
+   brd->GetAllMoves(&moves);
+   for (mIter = moves.begin(); mIter != moves.end(); mIter++) {
+      brd->ApplyMove((*mIter)->Clone());
+      (*numBoards)++;
+      rank = GetRank(GetEntry(brd));
+      brd->UndoLastMove();
+
+      if (!pick || rank > bestRank) {
+         delete pick;
+         pick = *mIter;
+         bestRank = rank;
+      }
+      else
+         delete *mIter;
+   }
+   return pick;
+}
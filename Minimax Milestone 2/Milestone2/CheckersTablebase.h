@@ -0,0 +1,101 @@
+#ifndef CHECKERSTABLEBASE_H
+#define CHECKERSTABLEBASE_H
+
+#include <iostream>
+#include <string>
+#include "EndgameSolver.h"
+#include "MyLib.h"
+
+// Distance-to-end database for CheckersBoards with few pieces, built by
+// Generate and read back (memory-mapped where possible) by Load.
+//
+// Positions are grouped into slices by total piece count n, from 2 up to the
+// database's maximum.  Within a slice, a position's index combines the rank
+// of its set of occupied cells among all C(32, n) such sets, a 2-bit code
+// per occupied cell (white or black, king or not), and the side to move.
+// Each index holds a one-byte entry: kInvalid for impossible positions (men
+// on their crowning row, one side absent), kDraw for a draw, or kDecided
+// plus the number of halfmoves to the end of the game, the winner ending it
+// as soon as it can and the loser putting it off as long as it can.  The
+// winner makes the last move, so the side to move wins if that distance is
+// odd, and loses if it is even.
+//
+// On disk, each slice is cut into blocks of kBlockSize entries, each block
+// run-length encoded by itself, with a table of block offsets so that a
+// probe decodes at most one block.
+class CheckersTablebase : public EndgameSolver {
+public:
+   enum {kInvalid = 0, kDraw = 1, kDecided = 2, kMaxDistance = 253};
+   enum {kMinPieces = 2, kMaxPieces = 5, kBlockSize = 1024};
+
+   CheckersTablebase();
+   ~CheckersTablebase();
+
+   // Build the database for up to maxPieces pieces, writing it to os.  If
+   // log is non-NULL, report each slice's results to it as they finish.
+   static void Generate(int maxPieces, std::ostream &os, std::ostream *log);
+
+   // Use the database in file 'path', replacing any loaded before.  Return
+   // false, with none loaded, if the file can't be read.
+   bool Load(const std::string &path);
+   int GetMaxPieces() const {return mMaxPieces;}
+
+   // Return the number of pieces left, if the database covers *brd, and
+   // otherwise a count beyond any database.
+   int GetRemaining(const Board *brd) const;
+
+   // Probe gives only a board's result, as kWinVal, 0 or -kWinVal, however
+   // far off the end is, so a search that probes the database can't tell a
+   // quick win from a slow one, and may make no progress in a won ending.
+   // Solve picks its moves by distance, and so does make progress.
+   bool Probe(const Board *brd, long *value) const;
+   long Solve(Board *brd, BestMove *res) const;
+
+protected:
+   typedef ulong Set;
+
+   // Encoded blocks are a series of stretches, each starting with a count
+   // byte.  With kRunFlag set, the rest of the count byte is one less than
+   // the length of a run of equal entries, and the entry follows.  Without
+   // it, the count byte is one less than the number of entries that follow
+   // it literally.  Runs shorter than kMinRun are written as literals.
+   enum {kNumCells = 32, kRunFlag = 0x80, kMaxRun = 128, kMinRun = 3};
+
+   // Location of one slice's data in the loaded file.
+   struct Slice {
+      ulong numEntries;
+      const uint *offsets;        // Block offsets, from 'data'
+      const unsigned char *data;  // Encoded blocks
+   };
+
+   static ulong GetSliceSize(int pieces);
+   static ulong GetIndex(Set black, Set white, Set kings, bool whiteMoves,
+    int *pieces);
+   static void GetPosition(int pieces, ulong index, Set *black, Set *white,
+    Set *kings, bool *whiteMoves);
+   static bool IsValid(Set black, Set white, Set kings);
+   static bool IsWin(int entry)
+    {return entry >= kDecided && (entry - kDecided) % 2 == 1;}
+   static bool IsLoss(int entry)
+    {return entry >= kDecided && (entry - kDecided) % 2 == 0;}
+   static int GetRank(int entry);
+   static void WriteSlice(std::ostream &os, const unsigned char *entries,
+    ulong numEntries);
+
+   int Lookup(Set black, Set white, Set kings, bool whiteMoves) const;
+   int GetEntry(const Board *brd) const;
+   Board::Move *PickMove(Board *brd, long *numBoards) const;
+   void Unload();
+
+   static ulong mBinomials[kNumCells + 1][kMaxPieces + 1];
+
+   int mMaxPieces;                  // 0 if none loaded
+   Slice mSlices[kMaxPieces + 1];
+   char *mFile;                     // Loaded file's contents
+   ulong mFileSize;
+   bool mMapped;                    // mFile is mapped, not allocated
+
+   static CheckersTablebase mBase;
+};
+
+#endif
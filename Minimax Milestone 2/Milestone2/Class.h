@@ -54,9 +54,10 @@ protected:
 //
 // 2. Access to the view and dialog classes that go with the Board
 //
-// 3. Two methods that return and modify the static Rules for the board class.  
-// Caller gets ownership of the object returned from GetOptions, 
-// and retains ownership of the object passed to SetOptions
+// 3. Two methods that return and modify the default Rules for the board class,
+// which each newly created board copies.  Existing boards keep their own
+// Rules (see Board::SetRules).  Caller gets ownership of the object returned 
+// from GetOptions, and retains ownership of the object passed to SetOptions
 //
 // 4. An indication of whether or not to use a transposition table when
 // doing minimax.
@@ -0,0 +1,20 @@
+#include "EndgameSolver.h"
+
+using namespace std;
+
+EndgameSolver *EndgameSolver::mHead;
+
+EndgameSolver::EndgameSolver(const string &boardName) : mBoardName(boardName),
+ mNext(mHead) {
+   mHead = this;
+}
+
+EndgameSolver *EndgameSolver::ForBoard(const Board *brd) {
+   EndgameSolver *cursor = mHead;
+   string name = brd->GetClass()->GetName();
+
+   while (cursor && cursor->mBoardName != name)
+      cursor = cursor->mNext;
+
+   return cursor;
+}
@@ -0,0 +1,49 @@
+#ifndef ENDGAMESOLVER_H
+#define ENDGAMESOLVER_H
+
+#include <string>
+#include "BestMove.h"
+
+// EndgameSolver is the base for exact solvers of a game's late boards, which
+// search all the way to the end of the game rather than to a fixed depth, 
+// using knowledge of the one game they serve.  As with Class, exactly one 
+// object of each subclass exists, and it adds itself to a linked list under 
+// the name of the Board class it solves, so that ForBoard can find the solver
+// (if any) for a given board.
+class EndgameSolver {
+public:
+   EndgameSolver(const std::string &boardName);
+   virtual ~EndgameSolver() {}
+
+   // Return how near *brd is to the end of its game, in whatever unit the 
+   // cost of solving it grows with (e.g. the number of empty squares).
+   virtual int GetRemaining(const Board *brd) const = 0;
+
+   // Solve *brd exactly, filling in *res as SimpleAIPlayer::Minimax would if
+   // searching to the end of the game.  res->value is thus kWinVal, 0 or 
+   // -kWinVal.  Return the solver's exact score for *brd, from the first 
+   // player's view, which also ranks wins and losses among themselves (e.g. 
+   // the final difference in pieces).  *brd is left unchanged.
+   virtual long Solve(Board *brd, BestMove *res) const = 0;
+
+   // If the solver can give *brd's exact value at once, without searching,
+   // return true with the value in *value, on GetValue's scale.  Otherwise
+   // return false.
+   virtual bool Probe(const Board * /*brd*/, long * /*value*/) const
+    {return false;}
+
+   // Load data the solver needs (e.g. a database file) from 'path'.  Return
+   // false if it can't be loaded, or if the solver uses no such data.
+   virtual bool Load(const std::string & /*path*/) {return false;}
+
+   // Return the solver for *brd's class, or NULL if there is none.
+   static EndgameSolver *ForBoard(const Board *brd);
+
+protected:
+   std::string mBoardName;       // Class name of the boards solved
+   EndgameSolver *mNext;         // Next solver on list
+
+   static EndgameSolver *mHead;  // Head of list of all solvers
+};
+
+#endif
@@ -0,0 +1,423 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include "Class.h"
+#include "Board.h"
+#include "View.h"
+#include "Book.h"
+#include "EndgameSolver.h"
+#include "Ponderer.h"
+#include "SearchTrace.h"
+
+using namespace std;
+
+// A long-running engine, taking one command per line on stdin and answering
+// on stdout, so that books, endgame data and the transposition table stay
+// loaded from one search to the next.  Commands:
+//
+// position BoardClass [file fileName]
+//    Start a new game of BoardClass, or load a board saved by BoardTest's
+//    saveBoard.  A change of class clears the transposition table.
+// move moveText            Apply a move, e.g. "move C3 -> D4"
+// undo                     Undo the last move
+// show                     Draw the board
+// go [depth N] [movetime ms] [infinite]
+//    Search in the background, to depth N (default 64) or for the given
+//    time, or until "stop".  Prints an "info" line per level finished, and
+//    then "bestmove move [reply move]", and then, unless a ponder search
+//    answered, an "info stats" line of the search's SearchStats.  With
+//    "infinite", depth and movetime are ignored, the book is not consulted,
+//    and bestmove waits for "stop" even if the search ends sooner.  Any
+//    command that must wait for the search ends an infinite one first.
+// stop                     End the search, and wait for its bestmove
+// setoption name Name value Value
+//    Ponder (on or off): after each bestmove, search the expected board
+//    Quiesce, QuiesceDepth, EndgameLimit, ProbeEndgames: as in
+//    SimpleAIPlayer::Options
+//    Book (file): answer from this book, made by MakeBook, where it can
+//    Endgames (file): load the board class's EndgameSolver data
+//    Trace (file or off): record later "go" searches, though not ponder
+//    searches, to a SearchTrace file, for TraceTool to read
+// clear                    Clear the transposition table
+// stats                    Report pondering and allocation counts, and then
+//                          an "info mem" line per MemStats kind
+// isready                  Answer "readyok"
+// quit
+//
+// Errors are reported as "error" lines.  Every response line may arrive
+// while a search runs, so lines are written whole under a lock.
+class Engine {
+public:
+   Engine();
+   ~Engine();
+
+   // Carry out one command line.  Return false on "quit".
+   bool Do(const string &line);
+
+protected:
+   void Say(const string &line);
+   void Position(istream &args);
+   void Go(istream &args);
+   void Search(Board *brd, int depth, double seconds, bool infinite);
+   void SetOption(istream &args);
+   void Wait();
+   void Reset();
+
+   const BoardClass *mClass;
+   Board *mBoard;
+   View *mView;
+   SearchService mService;
+   SearchService::Request mReq;
+   Ponderer *mPonderer;
+   Book *mBook;                 // Opening book, or NULL
+   SearchTrace *mTrace;         // Trace of "go" searches, or NULL
+   bool mPonder;
+
+   thread mSearcher;            // Runs the current "go", if any
+   CancelToken *mStop;          // Stops the current "go"
+   bool mInfinite;              // Current "go" runs until "stop"
+   mutex mOutLock;
+};
+
+Engine::Engine() : mClass(NULL), mBoard(NULL), mView(NULL), mService(1),
+ mPonderer(NULL), mBook(NULL), mTrace(NULL), mPonder(false), mStop(NULL),
+ mInfinite(false) {}
+
+Engine::~Engine() {
+   if (mStop)
+      mStop->Cancel();
+   Wait();
+   delete mPonderer;
+   delete mBook;
+   delete mTrace;
+   delete mView;
+   delete mBoard;
+}
+
+bool Engine::Do(const string &line) {
+   istringstream args(line);
+   string cmd, text;
+
+   if (!(args >> cmd))
+      return true;
+
+   if (cmd == "quit")
+      return false;
+   else if (cmd == "isready")
+      Say("readyok");
+   else if (cmd == "stop") {
+      if (mStop)
+         mStop->Cancel();
+      Wait();
+   }
+   else if (cmd == "position") {
+      Wait();
+      Position(args);
+   }
+   else if (cmd == "setoption") {
+      Wait();
+      SetOption(args);
+   }
+   else if (!mBoard)
+      Say("error no position");
+   else if (cmd == "go") {
+      Wait();
+      Go(args);
+   }
+   else if (cmd == "move") {
+      Board::Move *move = mBoard->CreateMove();
+      list<Board::Move *> moves;
+      list<Board::Move *>::iterator mIter;
+      bool legal = false;
+
+      Wait();
+      getline(args >> ws, text);
+      if (text.empty()) {
+         Say("error no move given");
+         delete move;
+         return true;
+      }
+      try {
+         *move = text;
+      }
+      catch (BaseException &exc) {
+         Say(string("error ") + exc.what());
+         delete move;
+         return true;
+      }
+      // Other parse failures, e.g. text too short for the move's format
+      catch (exception &exc) {
+         Say("error bad move " + text);
+         delete move;
+         return true;
+      }
+
+      mBoard->GetAllMoves(&moves);
+      for (mIter = moves.begin(); mIter != moves.end(); mIter++) {
+         legal = legal || **mIter == *move;
+         delete *mIter;
+      }
+      if (legal)
+         mBoard->ApplyMove(move);
+      else {
+         Say("error illegal move " + text);
+         delete move;
+      }
+   }
+   else if (cmd == "undo") {
+      Wait();
+      if (mBoard->GetMoveHist().size())
+         mBoard->UndoLastMove();
+      else
+         Say("error no move to undo");
+   }
+   else if (cmd == "show") {
+      ostringstream out;
+
+      Wait();
+      mView->Draw(out);
+      Say(out.str());
+   }
+   else if (cmd == "clear") {
+      Wait();
+      Reset();
+   }
+   else if (cmd == "stats") {
+      Wait();
+      const Ponderer::Stats &stats = mPonderer->GetStats();
+
+      Say(FString("info ponderhits %ld pondermisses %ld ponderboards %ld "
+       "pondertime %.3f moves %ld keys %ld", stats.hits, stats.misses,
+       stats.ponderBoards, stats.hitSeconds, Board::Move::GetOutstanding(),
+       Board::Key::GetOutstanding()));
+
+      ostringstream mem;
+
+      MemStats::Dump(mem, "info mem ");
+      text = mem.str();
+      Say(text.substr(0, text.size() - 1));
+   }
+   else
+      Say("error unknown command " + cmd);
+
+   return true;
+}
+
+void Engine::Say(const string &line) {
+   lock_guard<mutex> lock(mOutLock);
+
+   cout << line << endl;
+}
+
+void Engine::Position(istream &args) {
+   const BoardClass *cls;
+   string name, word, fileName;
+   Board *brd;
+
+   args >> name >> word >> fileName;
+   cls = dynamic_cast<const BoardClass *>(BoardClass::ForName(name));
+   if (!cls) {
+      Say("error unknown board class " + name);
+      return;
+   }
+
+   brd = dynamic_cast<Board *>(cls->NewInstance());
+   if (word == "file") {
+      ifstream in(fileName.c_str(), ios::binary);
+
+      if (!in.is_open()) {
+         Say("error can't open " + fileName);
+         delete brd;
+         return;
+      }
+      try {
+         in >> *brd;
+      }
+      catch (exception &exc) {
+         in.setstate(ios::failbit);
+      }
+      if (!in) {
+         Say("error can't read a board from " + fileName);
+         delete brd;
+         return;
+      }
+   }
+
+   delete mBoard;
+   mBoard = brd;
+   if (cls != mClass) {
+      mClass = cls;
+      delete mView;
+      mView = dynamic_cast<View *>(cls->GetViewClass()->NewInstance());
+      delete mBook;
+      mBook = NULL;
+      Reset();
+   }
+   mView->SetModel(mBoard);
+}
+
+// Parse the limits, answer from the book if it has the board, and otherwise
+// start the search on a copy of the board, so that later commands may go on
+// changing mBoard.
+void Engine::Go(istream &args) {
+   int depth = PVLine::kMaxPly;
+   double seconds = 0.0;
+   const Board::Key *key;
+   Book::iterator bIter;
+   bool infinite = false;
+   string word;
+
+   while (args >> word)
+      if (word == "depth")
+         args >> depth;
+      else if (word == "movetime") {
+         args >> seconds;
+         seconds /= 1000.0;
+      }
+      else if (word == "infinite")
+         infinite = true;
+
+   if (infinite) {
+      depth = PVLine::kMaxPly;
+      seconds = 0.0;
+   }
+   else if (mBook) {
+      key = mBoard->GetKey();
+      bIter = mBook->find(key);
+      delete key;
+      if (bIter != mBook->end() && bIter->second.HasMove()) {
+         Say("info book");
+         Say("bestmove " + mBoard->GetMoveText(bIter->second.move)
+          + (bIter->second.HasReply() ? " reply "
+          + mBoard->GetMoveText(bIter->second.replyMove) : ""));
+         return;
+      }
+   }
+
+   mStop = new CancelToken();
+   mInfinite = infinite;
+   mSearcher = thread(&Engine::Search, this, mBoard->Clone(), TMax(depth, 1),
+    seconds, infinite);
+}
+
+void Engine::Search(Board *brd, int depth, double seconds, bool infinite) {
+   SearchService::Request req(mReq);
+   SearchStats stats;
+   ostringstream out;
+   BestMove best;
+
+   req.maxDepth = depth;
+   req.seconds = seconds;
+   req.stats = &stats;
+   req.progress = [this, brd](const SearchService::Progress &prg) {
+      Say(FString("info depth %d value %ld boards %ld time %.3f move ",
+       prg.depth, prg.best->value, prg.numBoards, prg.seconds)
+       + (prg.best->HasMove() ? brd->GetMoveText(prg.best->move) : "none"));
+   };
+   mPonderer->SetRequest(req);
+
+   best = mPonderer->Think(brd, mStop);
+   while (infinite && !mStop->IsCancelled())
+      this_thread::sleep_for(chrono::milliseconds(10));
+   Say("bestmove " + (best.HasMove() ? brd->GetMoveText(best.move) : "none")
+    + (best.HasReply() ? " reply " + brd->GetMoveText(best.replyMove) : ""));
+   if (stats.GetNodes()) {
+      stats.Write(out);
+      Say("info stats " + out.str());
+   }
+
+   if (mPonder)
+      mPonderer->Ponder(brd, best);
+   delete brd;
+}
+
+void Engine::SetOption(istream &args) {
+   string word, name, value;
+   EndgameSolver *solver;
+   ifstream in;
+
+   args >> word >> name >> word;
+   getline(args >> ws, value);
+
+   if (name == "Ponder") {
+      mPonder = value == "on" || value == "true";
+      if (!mPonder && mPonderer)
+         mPonderer->Stop();
+   }
+   else if (name == "Quiesce")
+      mReq.opts.quiesce = value == "on" || value == "true";
+   else if (name == "QuiesceDepth")
+      mReq.opts.quiesceDepth = atoi(value.c_str());
+   else if (name == "EndgameLimit")
+      mReq.opts.endgameLimit = atoi(value.c_str());
+   else if (name == "ProbeEndgames")
+      mReq.opts.probeEndgames = value == "on" || value == "true";
+   else if (name == "Book" || name == "Endgames") {
+      if (!mBoard) {
+         Say("error no position");
+         return;
+      }
+      if (name == "Book") {
+         in.open(value.c_str(), ios::binary);
+         if (!in.is_open()) {
+            Say("error can't open " + value);
+            return;
+         }
+         delete mBook;
+         mBook = new Book();
+         mBook->Read(in, mClass);
+         Say(FString("info book entries %d", (int)mBook->size()));
+      }
+      else {
+         // A ponder search may be probing the solver's data.
+         mPonderer->Stop();
+         if (!(solver = EndgameSolver::ForBoard(mBoard))
+          || !solver->Load(value))
+            Say("error can't load endgames from " + value);
+      }
+   }
+   else if (name == "Trace") {
+      delete mTrace;
+      mTrace = NULL;
+      if (value != "off" && !(mTrace = new SearchTrace(value))->IsOpen()) {
+         Say("error can't open " + value);
+         delete mTrace;
+         mTrace = NULL;
+      }
+      mReq.opts.trace = mTrace;
+   }
+   else
+      Say("error unknown option " + name);
+}
+
+// Wait for the current search, if any, to finish, ending it first if it
+// would otherwise run until "stop".
+void Engine::Wait() {
+   if (mInfinite && mStop)
+      mStop->Cancel();
+   if (mSearcher.joinable())
+      mSearcher.join();
+   delete mStop;
+   mStop = NULL;
+   mInfinite = false;
+}
+
+// Drop the transposition table and any pondering, by starting afresh.
+void Engine::Reset() {
+   delete mPonderer;
+   mPonderer = new Ponderer(&mService, mReq);
+}
+
+int main() {
+   Engine engine;
+   string line;
+
+   while (getline(cin, line) && engine.Do(line))
+      ;
+
+   return 0;
+}
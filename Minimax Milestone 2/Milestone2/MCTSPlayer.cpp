@@ -0,0 +1,252 @@
+#include <assert.h>
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MCTSPlayer.h"
+#include "MyLib.h"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+// One board of the search tree, reached from its parent by 'move'.  Its
+// moves are generated the first time a playout reaches it, and are then
+// given children one by one, in random order, as later playouts pass
+// through it.  'score' totals the playout results from the view of 'mover',
+// the player who made 'move', counting a win 1 and a draw 1/2.
+struct MCTSPlayer::Node {
+   Board::Move *move;
+   Node *parent;
+   int mover;
+   long visits;
+   double score;
+   bool expanded;                 // untried has been filled
+   list<Board::Move *> untried;   // Moves not yet given a child
+   vector<Node *> children;
+
+   Node(Node *par, Board::Move *mv, int mvr) : move(mv), parent(par),
+    mover(mvr), visits(0), score(0.0), expanded(false) {}
+
+   ~Node() {
+      list<Board::Move *>::iterator mIter;
+      vector<Node *>::iterator cIter;
+
+      delete move;
+      for (mIter = untried.begin(); mIter != untried.end(); mIter++)
+         delete *mIter;
+      for (cIter = children.begin(); cIter != children.end(); cIter++)
+         delete *cIter;
+   }
+};
+
+// A tree, and the lock its threads take turns with when it is shared.
+struct MCTSPlayer::Tree {
+   Node *root;
+   bool shared;
+   mutex lock;
+   int maxDepth;
+
+   Tree(Node *rt, bool shr) : root(rt), shared(shr), maxDepth(0) {}
+   ~Tree() {delete root;}
+
+   void Lock() {if (shared) lock.lock();}
+   void Unlock() {if (shared) lock.unlock();}
+};
+
+// Playout allowance common to all threads of a search.
+struct MCTSPlayer::Budget {
+   atomic<long> started, finished;
+   long limit;                    // Playouts allowed, or 0 for no limit
+   bool timed;
+   Clock::time_point end;
+
+   Budget(const Options &opts) : started(0), finished(0),
+    limit(opts.iterations), timed(opts.seconds > 0.0) {
+      end = Clock::now() + chrono::duration_cast<Clock::duration>(
+       chrono::duration<double>(opts.seconds));
+   }
+
+   // Claim one more playout, if any are left.  The first is always
+   // allowed, however short the time, so that the root has a child to
+   // report.
+   bool Next() {
+      long count = started++;
+
+      if (limit && count >= limit)
+         return false;
+      return count == 0 || !timed || Clock::now() < end;
+   }
+};
+
+void MCTSPlayer::Search(Board *brd, const Options &opts, BestMove *res) {
+   int numTrees = opts.sharedTree ? 1 : TMax(opts.threads, 1), ndx, best;
+   vector<Tree *> trees;
+   vector<Board *> boards;
+   vector<thread> workers;
+   vector<Node *> moves;          // Distinct root moves, from any tree
+   vector<long> visits;
+   vector<double> scores;
+   vector<Node *>::iterator cIter;
+   list<Board::Move *> rootMoves;
+   Budget budget(opts);
+   Node *child, *reply;
+   double p0Score;
+
+   assert(opts.iterations > 0 || opts.seconds > 0.0);
+
+   brd->GetAllMoves(&rootMoves);
+   if (rootMoves.size() == 0) {
+      res->Clear(0, 1);
+      res->value = brd->GetValue();
+      return;
+   }
+   for (; rootMoves.size(); rootMoves.pop_front())
+      delete rootMoves.front();
+
+   for (ndx = 0; ndx < numTrees; ndx++)
+      trees.push_back(new Tree(new Node(NULL, NULL, 1 - brd->GetWhoseMove()),
+       opts.sharedTree));
+
+   // Each thread plays out on its own copy of the board.
+   for (ndx = 0; ndx < TMax(opts.threads, 1); ndx++)
+      boards.push_back(brd->Clone());
+   if (boards.size() == 1)
+      Grow(trees[0], boards[0], opts, &budget, opts.seed);
+   else {
+      for (ndx = 0; ndx < (int)boards.size(); ndx++)
+         workers.push_back(thread(Grow, trees[ndx % numTrees], boards[ndx],
+          cref(opts), &budget, opts.seed + ndx));
+      for (ndx = 0; ndx < (int)workers.size(); ndx++)
+         workers[ndx].join();
+   }
+
+   // Sum the root children's statistics across the trees, by move.  The
+   // first playout, which Budget always allows, gave some tree a child.
+   for (ndx = 0; ndx < numTrees; ndx++) {
+      for (cIter = trees[ndx]->root->children.begin();
+       cIter != trees[ndx]->root->children.end(); cIter++) {
+         for (best = 0; best < (int)moves.size()
+          && !(*moves[best]->move == *(*cIter)->move); best++)
+            ;
+         if (best == (int)moves.size()) {
+            moves.push_back(*cIter);
+            visits.push_back(0);
+            scores.push_back(0.0);
+         }
+         else if ((*cIter)->visits > moves[best]->visits)
+            moves[best] = *cIter;     // Keep the fullest subtree for the reply
+         visits[best] += (*cIter)->visits;
+         scores[best] += (*cIter)->score;
+      }
+   }
+
+   assert(moves.size() > 0);
+   for (best = 0, ndx = 1; ndx < (int)moves.size(); ndx++)
+      if (visits[ndx] > visits[best])
+         best = ndx;
+
+   child = moves[best];
+   reply = MostVisited(child);
+   p0Score = scores[best] / visits[best];
+   if (child->mover != 0)
+      p0Score = 1.0 - p0Score;
+
+   res->Clear(0, budget.finished);
+   res->move = child->move->GetCode();
+   res->replyMove = reply ? reply->move->GetCode() : Board::Move::kNoCode;
+   res->value = (long)((2.0 * p0Score - 1.0) * kScale);
+   for (ndx = 0; ndx < numTrees; ndx++)
+      res->depth = TMax(res->depth, (long)trees[ndx]->maxDepth);
+
+   for (ndx = 0; ndx < numTrees; ndx++)
+      delete trees[ndx];
+   for (ndx = 0; ndx < (int)boards.size(); ndx++)
+      delete boards[ndx];
+}
+
+// Run playouts on *brd until the budget runs out, growing *tree by one node
+// with each.  The path down the tree is counted as visited as soon as it is
+// chosen, so that other threads sharing the tree see it as already tried
+// (a "virtual loss") while this thread plays out below it.
+void MCTSPlayer::Grow(Tree *tree, Board *brd, const Options &opts,
+ Budget *budget, unsigned seed) {
+   XorShift rng(seed);
+   list<Board::Move *>::iterator mIter;
+   Node *node;
+   int depth, pick;
+   double result;
+
+   while (budget->Next()) {
+      tree->Lock();
+      node = tree->root;
+      node->visits++;
+      for (depth = 0; node->expanded && node->untried.size() == 0
+       && node->children.size(); depth++) {
+         node = Select(node, opts.exploration);
+         brd->ApplyMove(node->move->Clone());
+         node->visits++;
+      }
+
+      if (!node->expanded) {
+         brd->GetAllMoves(&node->untried);
+         node->expanded = true;
+      }
+      if (node->untried.size()) {
+         pick = rng.Below(node->untried.size());
+         for (mIter = node->untried.begin(); pick--; mIter++)
+            ;
+         node->children.push_back(new Node(node, *mIter,
+          brd->GetWhoseMove()));
+         node->untried.erase(mIter);
+         node = node->children.back();
+         brd->ApplyMove(node->move->Clone());
+         node->visits++;
+         depth++;
+      }
+      tree->maxDepth = TMax(tree->maxDepth, depth);
+      tree->Unlock();
+
+      result = (brd->Playout(&rng, opts.maxPlayout) + 1) / 2.0;
+
+      tree->Lock();
+      for (; node; node = node->parent)
+         node->score += node->mover == 0 ? result : 1.0 - result;
+      tree->Unlock();
+
+      for (; depth > 0; depth--)
+         brd->UndoLastMove();
+      budget->finished++;
+   }
+}
+
+// Return the child of *node with the best upper confidence bound.
+MCTSPlayer::Node *MCTSPlayer::Select(const Node *node, double exploration) {
+   vector<Node *>::const_iterator cIter;
+   double logVisits = log((double)node->visits), bound, bestBound = -1.0;
+   Node *best = NULL;
+
+   for (cIter = node->children.begin(); cIter != node->children.end();
+    cIter++) {
+      bound = (*cIter)->score / (*cIter)->visits
+       + exploration * sqrt(logVisits / (*cIter)->visits);
+      if (bound > bestBound) {
+         bestBound = bound;
+         best = *cIter;
+      }
+   }
+   return best;
+}
+
+MCTSPlayer::Node *MCTSPlayer::MostVisited(const Node *node) {
+   vector<Node *>::const_iterator cIter;
+   Node *best = NULL;
+
+   for (cIter = node->children.begin(); cIter != node->children.end();
+    cIter++)
+      if (!best || (*cIter)->visits > best->visits)
+         best = *cIter;
+   return best;
+}
@@ -0,0 +1,65 @@
+#ifndef MCTSPLAYER_H
+#define MCTSPLAYER_H
+
+#include "BestMove.h"
+
+// Monte Carlo tree search player.  Rather than evaluating boards with
+// GetValue at a fixed depth, it grows a tree by UCT (upper confidence bounds
+// applied to trees), scoring each new leaf by one random playout to the end
+// of the game.  Its cost is set directly, by a playout count or a time limit,
+// however wide the boards are.  Like SimpleAIPlayer it works through the
+// Board interface alone, and it reports its choice as a BestMove.
+class MCTSPlayer {
+public:
+   // Scale of BestMove::value: a certain win for player 0 is kScale, a
+   // certain loss -kScale.
+   enum {kScale = 1000};
+
+   struct Options {
+      // Stop after this many playouts in all, or after this many seconds,
+      // whichever comes first.  0 turns either limit off, but not both.
+      long iterations;
+      double seconds;
+
+      // Threads to search on.  With sharedTree set, they all grow one tree,
+      // taking turns at it between playouts (tree parallelism).  Otherwise
+      // each grows its own tree from a copy of the board, and the trees'
+      // root statistics are summed at the end (root parallelism).
+      int threads;
+      bool sharedTree;
+
+      // UCT exploration constant.  Larger values spread playouts more evenly
+      // over the moves, smaller ones concentrate on the best-looking.
+      double exploration;
+
+      // Halfmoves after which an unfinished playout is scored as the board's
+      // Playout scores it, for games that can run on indefinitely.
+      int maxPlayout;
+
+      // Seed for the playouts' random choices.  Thread n uses seed + n.
+      unsigned seed;
+
+      Options() : iterations(10000), seconds(0.0), threads(1),
+       sharedTree(false), exploration(1.4), maxPlayout(200), seed(1) {}
+   };
+
+   // Search *brd, setting res->move to the move played out most often and
+   // res->replyMove to the most played reply to it.  res->value is player 0's
+   // expected result after res->move, on the kScale scale, res->depth the
+   // deepest tree level reached, and res->numBoards the number of playouts.
+   // If the game is over on *brd, res->move is kNoCode and res->value is
+   // brd->GetValue().  *brd is left as it was.
+   static void Search(Board *brd, const Options &opts, BestMove *res);
+
+private:
+   struct Node;
+   struct Tree;
+   struct Budget;
+
+   static void Grow(Tree *tree, Board *brd, const Options &opts,
+    Budget *budget, unsigned seed);
+   static Node *Select(const Node *node, double exploration);
+   static Node *MostVisited(const Node *node);
+};
+
+#endif
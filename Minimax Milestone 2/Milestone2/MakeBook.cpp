@@ -6,12 +6,13 @@
 #include "Book.h"
 #include "Board.h"
 #include "SimpleAIPlayer.h"
+#include "SearchStats.h"
 #include "View.h"
 
 using namespace std;
 
 void ConstructBookFileDFS(Board *board, View *view, Book *bookFile, bool useX,
- int minimaxDepth, int bookDepth);
+ int minimaxDepth, int bookDepth, SearchStats *stats);
 
 // [Staley] Write a program MakeBook that works like the sample executable 
 // [Staley] provided.  MakeBook prompts for and accepts a single line of input 
@@ -90,6 +91,7 @@ int main() {
    int level = -1, depth = -1;
    string boardType(""), filename("");
    Book *bookFile = new Book();
+   SearchStats stats;
    ofstream out;
    
    // First, prompt the user for commands of the following usage:
@@ -110,7 +112,7 @@ int main() {
 
    // Create the "bookFile file".  This is where all the work happens.
    ConstructBookFileDFS(board, view, bookFile, boardClass->UseTransposition(), 
-    level, depth);
+    level, depth, &stats);
 
    // When the bookFile is complete (after you finish running the DFS), write it
    // to a binary "bookFile file" having the specified fileName.
@@ -125,6 +127,11 @@ int main() {
    cout << "Final count, moves/keys: " << Board::Move::GetOutstanding() << "/"
     << Board::Key::GetOutstanding() << endl;
 
+   // Search counts go to cerr, keeping cout to the output that must match.
+   cerr << "Search stats: ";
+   stats.Write(cerr);
+   cerr << endl;
+
    return 0;
 }
 
@@ -135,12 +142,13 @@ int main() {
 // bestMove is, using the lookahead specified from the user in our prompt 
 // from the beginning.
 void ConstructBookFileDFS(Board *board, View *view, Book *bookFile, bool useX,
- int level, int depth) {
+ int level, int depth, SearchStats *stats) {
    list<Board::Move *> allMoves;
    list<Board::Move *>::iterator moveIter = allMoves.begin();
    const Board::Key *key = NULL;
    BestMove bestMove;
    Book *tTable = new Book();
+   SimpleAIPlayer::Options opts;
 
    // Output the current key/move count.
    // [Staley] A hint on how to duplicate my key count:  When I analyze a 
@@ -160,22 +168,24 @@ void ConstructBookFileDFS(Board *board, View *view, Book *bookFile, bool useX,
 
    // Once you're ready to call Minimax(), create a new tTable for that
    // particular Minimax call (quoted from "Transposition Table" email).
+   opts.stats = stats;
    SimpleAIPlayer::Minimax(board, level, -Board::kWinVal-1, Board::kWinVal+1, 
-    &bestMove, useX ? tTable : NULL);
+    &bestMove, useX ? tTable : NULL, NULL, opts);
 
    // Clean up afterwards.
    delete tTable;
 
    // Report current stats to the user.
-   cout << "Best move: " << (string) *bestMove.move << " with reply ";
-   cout << (bestMove.replyMove ? (string) *bestMove.replyMove : "unknown") 
-    << endl;
+   cout << "Best move: " << board->GetMoveText(bestMove.move)
+    << " with reply ";
+   cout << (bestMove.HasReply() ? board->GetMoveText(bestMove.replyMove)
+    : "unknown") << endl;
    cout << " Boards examined: " << bestMove.numBoards;
    cout << " Value: " << bestMove.value << endl;
 
    // Once you finish running the Minimax for that node, add the
    // bestMove that you got into your bookFile.
-   bookFile->insert(pair<const Board::Key *, BestMove>(key, bestMove));   
+   bookFile->insert(Book::value_type(key, bestMove));
    cout << "Added as board " << bookFile->size() << endl << endl;
 
    if (depth > 0) {
@@ -187,7 +197,8 @@ void ConstructBookFileDFS(Board *board, View *view, Book *bookFile, bool useX,
 
          // The DFS should step down the tree in a depth-first manner until 
          // it reaches its desired depth level.
-         ConstructBookFileDFS(board, view, bookFile, useX, level, depth-1);
+         ConstructBookFileDFS(board, view, bookFile, useX, level, depth-1,
+          stats);
 
          board->UndoLastMove();
       }  
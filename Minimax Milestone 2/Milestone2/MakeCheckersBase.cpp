@@ -0,0 +1,41 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <ctime>
+#include "CheckersTablebase.h"
+
+using namespace std;
+
+// Build the checkers endgame database.  Usage:
+//
+// MakeCheckersBase maxPieces fileName
+//
+// Each slice's win/loss/draw counts, and its longest distance to the end,
+// are reported as it is finished.  Three pieces take a moment; four take a
+// minute or so, and give a 10MB file.
+int main(int argc, char **argv) {
+   int maxPieces = argc > 1 ? atoi(argv[1]) : 0;
+   clock_t start = clock();
+   ofstream out;
+
+   if (argc != 3 || maxPieces < CheckersTablebase::kMinPieces
+    || maxPieces > CheckersTablebase::kMaxPieces) {
+      cout << "Usage: MakeCheckersBase maxPieces fileName (maxPieces from "
+       << CheckersTablebase::kMinPieces << " to "
+       << CheckersTablebase::kMaxPieces << ")" << endl;
+      return -1;
+   }
+
+   out.open(argv[2], ios::binary);
+   if (!out) {
+      cout << "Can't open " << argv[2] << endl;
+      return -1;
+   }
+
+   CheckersTablebase::Generate(maxPieces, out, &cout);
+   out.close();
+
+   cout << "Done in " << (double)(clock() - start) / CLOCKS_PER_SEC << "s"
+    << endl;
+   return 0;
+}
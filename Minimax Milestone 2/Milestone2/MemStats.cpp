@@ -0,0 +1,69 @@
+#include <chrono>
+#include <mutex>
+#include "MemStats.h"
+#include "MyLib.h"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+static const char *const kNames[MemStats::kNumKinds] = {
+   "Moves", "Keys", "Boards", "BestMoves", "BookEntries", "PoolSlabs",
+   "ArenaBlocks"
+};
+
+// Guards the peaks.
+static mutex gLock;
+static long gPeak[MemStats::kNumKinds];
+
+// State of the last Dump, from which it measures allocation rates.
+static mutex gDumpLock;
+static Clock::time_point gLastDump = Clock::now();
+static long gLastAllocs[MemStats::kNumKinds];
+
+MemStats::Snapshot MemStats::Get(Kind kind) {
+   Snapshot rtn = {0, 0, 0, 0};
+
+   Shards::ForEach([&](const Shard &shard) {
+      rtn.live += shard.live[kind].load(memory_order_relaxed);
+      rtn.allocs += shard.allocs[kind].load(memory_order_relaxed);
+      rtn.bytes += shard.bytes[kind].load(memory_order_relaxed);
+   });
+
+   lock_guard<mutex> lock(gLock);
+   rtn.peak = gPeak[kind] = TMax(gPeak[kind], rtn.live);
+   return rtn;
+}
+
+const char *MemStats::GetName(Kind kind) {
+   return kNames[kind];
+}
+
+void MemStats::Dump(ostream &os, const string &prefix) {
+   lock_guard<mutex> lock(gDumpLock);
+   Clock::time_point now = Clock::now();
+   double seconds = chrono::duration<double>(now - gLastDump).count();
+   Snapshot snap;
+   int kind;
+
+   for (kind = 0; kind < kNumKinds; kind++) {
+      snap = Get((Kind)kind);
+      os << prefix << FString("%s live %ld peak %ld allocs %ld bytes %ld "
+       "rate %.0f", kNames[kind], snap.live, snap.peak, snap.allocs,
+       snap.bytes, seconds > 0.0 ? (snap.allocs - gLastAllocs[kind])
+       / seconds : 0.0) << endl;
+      gLastAllocs[kind] = snap.allocs;
+   }
+   gLastDump = now;
+}
+
+// Add an ended thread's counts to these.
+void MemStats::Shard::Add(const Shard &src) {
+   int kind;
+
+   for (kind = 0; kind < kNumKinds; kind++) {
+      MemStats::Add(&live[kind], src.live[kind].load(memory_order_relaxed));
+      MemStats::Add(&allocs[kind], src.allocs[kind].load(memory_order_relaxed));
+      MemStats::Add(&bytes[kind], src.bytes[kind].load(memory_order_relaxed));
+   }
+}
@@ -0,0 +1,93 @@
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include "ThreadShards.h"
+
+// Counts of the objects a search allocates, by kind: how many are live, the
+// most ever live at once, how many have been allocated in all, and the bytes
+// the live ones take.  The allocating classes report each allocation and
+// free here, and anyone may read the counts with Get, or print them all with
+// Dump, at any time and from any thread.
+//
+// Each thread counts in a Shard of its own (see ThreadShards), so a report
+// is a few unlocked adds to memory no other thread writes.  Get sums the
+// shards, including that of threads since ended.  Peaks are sampled, on
+// every Get, after every kSampleEvery allocations of a kind on a thread,
+// and on any one allocation of kSampleBytes or more, so a peak may miss a
+// brief excursion above it.
+class MemStats {
+public:
+   enum Kind {
+      kMove,         // Moves of classes with pooled operator new
+      kKey,          // Keys
+      kBoard,        // Boards allocated with new
+      kBestMove,     // BestMoves, wherever they live
+      kBookEntry,    // Book nodes; bucket arrays count only toward bytes
+      kSlab,         // SlabPool slabs held from the system
+      kArena,        // Arena blocks held from the system
+      kNumKinds
+   };
+
+   struct Snapshot {
+      long live;     // Objects now allocated
+      long peak;     // Most seen live at once
+      long allocs;   // Allocations in all
+      long bytes;    // Bytes taken by the live objects
+   };
+
+   // Report 'count' objects of 'kind', taking 'bytes' in all, allocated or
+   // freed.
+   static void Alloc(Kind kind, long bytes, long count = 1) {
+      Shard &shard = Shards::Local();
+
+      Add(&shard.live[kind], count);
+      Add(&shard.allocs[kind], count);
+      Add(&shard.bytes[kind], bytes);
+      if ((shard.unsampled[kind] += count) >= kSampleEvery
+       || bytes >= kSampleBytes) {
+         shard.unsampled[kind] = 0;
+         Get(kind);
+      }
+   }
+
+   static void Free(Kind kind, long bytes, long count = 1) {
+      Shard &shard = Shards::Local();
+
+      Add(&shard.live[kind], -count);
+      Add(&shard.bytes[kind], -bytes);
+   }
+
+   static long GetLive(Kind kind) {return Get(kind).live;}
+
+   // Sum the counts of 'kind' over all threads, and raise its peak to the
+   // live count if that is higher.
+   static Snapshot Get(Kind kind);
+   static const char *GetName(Kind kind);
+
+   // Write a line per kind, each starting with 'prefix', giving its counts
+   // and its allocations per second since the last Dump (or program start).
+   static void Dump(std::ostream &os, const std::string &prefix = "");
+
+protected:
+   enum {kSampleEvery = 1024, kSampleBytes = 4096};
+
+   // One thread's counts.  Only the owning thread writes them, so they need
+   // atomics only for other threads' reads.
+   struct Shard {
+      std::atomic<long> live[kNumKinds], allocs[kNumKinds], bytes[kNumKinds];
+      long unsampled[kNumKinds];     // Allocations since the last sample
+
+      void Add(const Shard &src);
+   };
+   typedef ThreadShards<Shard> Shards;
+
+   static void Add(std::atomic<long> *ctr, long val) {
+      ctr->store(ctr->load(std::memory_order_relaxed) + val,
+       std::memory_order_relaxed);
+   }
+};
+
+#endif
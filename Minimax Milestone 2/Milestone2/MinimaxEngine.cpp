@@ -0,0 +1,57 @@
+#include "MinimaxEngine.h"
+
+using namespace std;
+
+MinimaxEngine *MinimaxEngine::mHead;
+
+// Engine for boards whose class has none of its own.
+static MinimaxT<Board> sGeneric("Board");
+
+MinimaxEngine::MinimaxEngine(const string &boardName) : mBoardName(boardName),
+ mNext(mHead) {
+   mHead = this;
+}
+
+const MinimaxEngine *MinimaxEngine::ForBoard(const Board *brd) {
+   MinimaxEngine *cursor = mHead;
+   string name = brd->GetClass()->GetName();
+
+   while (cursor && cursor->mBoardName != name)
+      cursor = cursor->mNext;
+
+   return cursor ? cursor : &sGeneric;
+}
+
+// Move the seed line's move for this ply, if present, to the front of *moves.
+void MinimaxEngine::SeedOrder(const Context *ctx, int ply,
+ list<Board::Move *> *moves) {
+   list<Board::Move *>::iterator mIter;
+
+   for (mIter = moves->begin(); mIter != moves->end(); mIter++)
+      if ((*mIter)->GetCode() == ctx->seed->moves[ply]) {
+         moves->splice(moves->begin(), *moves, mIter);
+         break;
+      }
+}
+
+// Make row 'ply' of the PV table be 'mv' followed by row ply+1, which holds
+// the line of the child just searched, leaving row ply+1 empty.
+void MinimaxEngine::SavePV(Context *ctx, int ply, const Board::Move *mv) {
+   uint *row;
+   int ndx, childLength;
+
+   if (ply >= PVLine::kMaxPly)
+      return;
+
+   ctx->ClearRow(ply);
+   row = ctx->pvTable[ply];
+   row[0] = mv->GetCode();
+
+   childLength = ply + 1 < PVLine::kMaxPly ? ctx->pvLength[ply + 1] : 0;
+   for (ndx = 0; ndx < childLength; ndx++)
+      row[ndx + 1] = ctx->pvTable[ply + 1][ndx];
+
+   ctx->pvLength[ply] = childLength + 1;
+   if (childLength)
+      ctx->pvLength[ply + 1] = 0;
+}
@@ -0,0 +1,376 @@
+#ifndef MINIMAXENGINE_H
+#define MINIMAXENGINE_H
+
+#include <iostream>
+#include <list>
+#include <string>
+#include <assert.h>
+#include "SimpleAIPlayer.h"
+#include "EndgameSolver.h"
+#include "CancelToken.h"
+#include "Book.h"
+#include "SearchStats.h"
+#include "SearchTrace.h"
+#include "PhaseTimer.h"
+
+// MinimaxEngine is the base for the searches behind SimpleAIPlayer::Minimax.
+// Each is a MinimaxT for one Board class B, whose nodes call B's methods
+// directly rather than through Board, so that the compiler can inline them
+// when B is final and MinimaxT<B> is instantiated beside B's definitions.  As
+// with EndgameSolver, exactly one engine exists per class, and it adds itself
+// to a linked list under the name of the Board class it searches, so that
+// ForBoard can find it.  Boards with no engine of their own are searched by a
+// MinimaxT<Board>, through virtual calls.
+class MinimaxEngine {
+public:
+   // State shared by all nodes of one top-level search.  pvTable is a
+   // triangular PV table: row 'ply' holds the best line found so far from
+   // the node being searched at that ply, built from the node's best move
+   // followed by the row its child left behind.  Rows are only kept if
+   // collectPV is set.  'stats' counts the search as it goes, for the
+   // caller to collect at the end.
+   struct Context {
+      Book *tTable;
+      const SimpleAIPlayer::Options &opts;
+      const EndgameSolver *solver;  // Solver to probe, or NULL
+      int dbg;
+      bool collectPV;
+      bool stopped;          // opts.cancel was found cancelled
+      const PVLine *seed;    // Line to try first, or NULL
+      SearchStats stats;
+      uint pvTable[PVLine::kMaxPly][PVLine::kMaxPly];   // Move codes
+      int pvLength[PVLine::kMaxPly];
+
+      Context(Book *bk, const SimpleAIPlayer::Options &o, bool pv,
+       const PVLine *sd, int d) : tTable(bk), opts(o), solver(NULL), dbg(d),
+       collectPV(pv), stopped(false), seed(sd) {
+         for (int ply = 0; ply < PVLine::kMaxPly; ply++)
+            pvLength[ply] = 0;
+      }
+
+      bool Stopped() {
+         return stopped
+          || (stopped = opts.cancel && opts.cancel->IsCancelled());
+      }
+
+      void ClearRow(int ply) {
+         if (ply < PVLine::kMaxPly)
+            pvLength[ply] = 0;
+      }
+   };
+
+   MinimaxEngine(const std::string &boardName);
+   virtual ~MinimaxEngine() {}
+
+   // Search *brd to depth 'lvl' within (min, max), as SimpleAIPlayer::Minimax
+   // describes, leaving the principal variation in row 0 of ctx->pvTable.
+   virtual void Search(Context *ctx, Board *brd, int lvl, long min, long max,
+    BestMove *res) const = 0;
+
+   // Return the engine for *brd's class, or the generic one if it has none.
+   static const MinimaxEngine *ForBoard(const Board *brd);
+
+protected:
+   static void SeedOrder(const Context *ctx, int ply,
+    std::list<Board::Move *> *moves);
+   static void SavePV(Context *ctx, int ply, const Board::Move *mv);
+
+   std::string mBoardName;        // Class name of the boards searched
+   MinimaxEngine *mNext;          // Next engine on list
+
+   static MinimaxEngine *mHead;   // Head of list of all engines
+};
+
+// The search itself, for boards of class B, with moves of class
+// GameTraits<B>::Move.
+template <class B>
+class MinimaxT : public MinimaxEngine {
+public:
+   MinimaxT(const std::string &boardName) : MinimaxEngine(boardName) {}
+
+   void Search(Context *ctx, Board *brd, int lvl, long min, long max,
+    BestMove *res) const
+    {SearchNode(ctx, static_cast<B *>(brd), lvl, 0, true, min, max, res);}
+
+protected:
+   typedef typename GameTraits<B>::Move Move;
+
+   static void SearchNode(Context *ctx, B *brd, int lvl, int ply, bool onPV,
+    long min, long max, BestMove *res);
+   static long Quiesce(Context *ctx, B *brd, int ply, int depth, long min,
+    long max, long *numBoards);
+};
+
+// Search the node 'ply' halfmoves below the root, filling in *bMove as
+// SimpleAIPlayer::Minimax describes.  'onPV' is true while the path from the
+// root follows the seed line, if any.
+template <class B>
+void MinimaxT<B>::SearchNode(Context *ctx, B *board, int minimaxLevel,
+ int ply, bool onPV, long min, long max, BestMove *bMove) {
+   Book *tTable = ctx->tTable;
+   int dbg = ctx->dbg;
+   std::list<Board::Move *> moves;
+   std::list<Board::Move *>::iterator mIter;
+   BestMove subBestMove(Board::Move::kNoCode, Board::Move::kNoCode, 0,
+    minimaxLevel, 1);
+   const Board::Key *key = 0;
+   Book::iterator bIter;
+   std::pair<Book::iterator, bool> ins;
+   long value;
+
+   // [Staley] Level 0 computations aren't worth it since a call of GetValue is
+   // [Staley] usually quicker than a tTable lookup.
+   // [Me] So, ensure that MakeBook doesn't call this method with
+   // minimaxLevel == 0.
+   assert(minimaxLevel >= 1);
+   ctx->stats.CountNode(ply);
+
+   // A board with a known exact value needs no search.  (The root must still
+   // be searched, for its move.)
+   if (ply > 0 && ctx->solver && ctx->solver->Probe(board, &value)) {
+      bMove->Clear(minimaxLevel, 1);
+      bMove->value = value;
+      if (ctx->collectPV)
+         ctx->ClearRow(ply);
+      return;
+   }
+
+   // The key may go into the table, so it comes from wherever the table's
+   // entries do, which may outlast this search's Arena.
+   if (tTable) {
+      Arena::Scope scope(tTable->GetArena());
+      PHASE_TIMER(kKey);
+
+      key = board->GetKey();
+      ctx->stats.ttProbes++;
+   }
+
+   // Before we begin "exploring" this node, first consult the transposition
+   // table to see if we already have a precomputed best move for its
+   // board configuration [Filled blank] "with minimaxLevel at least as deep
+   // as the one you need."
+   if (tTable && (bIter = PHASE_TIMED(kTable, tTable->find(key)))
+    != tTable->end()
+    && (*bIter).second.depth >= minimaxLevel) {
+      // [Filled blank] If we find the bestMove in the transposition table,
+      // then set the bestMove straightaway.
+      ctx->stats.ttHits++;
+      *bMove = (*bIter).second;
+      bMove->numBoards = 1;
+
+      // The stored move and reply are as much of the line as is known here.
+      if (ctx->collectPV && ply < PVLine::kMaxPly) {
+         ctx->ClearRow(ply);
+         if (bMove->HasMove())
+            ctx->pvTable[ply][ctx->pvLength[ply]++] = bMove->move;
+         if (bMove->HasReply() && ply + 1 < PVLine::kMaxPly)
+            ctx->pvTable[ply][ctx->pvLength[ply]++] = bMove->replyMove;
+      }
+   }
+   else {
+      // To begin "exploring" this node, first figure out what the list of
+      // possible moves is, so that you can construct the nodes at the
+      // minimaxLevel below you (one node created per Move).
+      PHASE_TIMED(kMoveGen, board->GetAllMoves(&moves));
+      if (ctx->collectPV)
+         ctx->ClearRow(ply);
+
+      // While following the seed line, search its move first.
+      onPV = onPV && ctx->seed && ply < ctx->seed->length;
+      if (onPV)
+         SeedOrder(ctx, ply, &moves);
+
+      // Fill up bestMove -- assume that the bestMove for this node is an empty
+      // BestMove.
+      bMove->Clear(minimaxLevel, 1);
+
+      // Edge case: If this node is an end-game node, then set this bestMove's
+      // value to be the appropriate kWinVal.
+      // [Filled blank] Otherwise, bestMove->value should just be the current
+      // value of the board.
+      bMove->value = moves.size() == 0 ? PHASE_TIMED(kEval, board->GetValue()) :
+       (board->GetWhoseMove() ? Board::kWinVal - 1 : -Board::kWinVal + 1);
+      if (moves.size() == 0)
+         ctx->stats.leafEvals++;
+
+      // Iterate through each of the possible moves, [Filled blank] provided
+      // that the limits for this node haven't collided yet.
+      for (mIter = moves.begin(); min < max && mIter != moves.end()
+       && !ctx->Stopped(); mIter++) {
+
+         PHASE_TIMED(kApply, board->ApplyMove(*mIter));
+
+         // Base case.  If the minimax recursion can't possibly go down another
+         // level because you're at your target Level, then stop recursing down.
+         if (minimaxLevel == 1) {
+            subBestMove.numBoards = 1;
+            ctx->stats.CountNode(ply + 1);
+            if (ctx->solver && ctx->solver->Probe(board, &subBestMove.value))
+               ;
+            else if (ctx->opts.quiesce)
+               subBestMove.value = Quiesce(ctx, board, ply + 1,
+                ctx->opts.quiesceDepth, min, max, &subBestMove.numBoards);
+            else {
+               subBestMove.value = PHASE_TIMED(kEval, board->GetValue());
+               ctx->stats.leafEvals++;
+            }
+            if (ctx->collectPV)
+               ctx->ClearRow(ply + 1);
+         }
+         else
+            SearchNode(ctx, board, minimaxLevel-1, ply+1, onPV
+             && (*mIter)->GetCode() == ctx->seed->moves[ply], min, max,
+             &subBestMove);
+
+         // A child cut short by cancellation has no trustworthy value.
+         if (ctx->stopped)
+            ;
+         // [Filled blank] Conditional: White pulls the floor up.
+         else if (board->GetWhoseMove() == 1 && subBestMove.value > min) {
+            bMove->value = min = subBestMove.value;
+
+            // [Filled blank] Set the best move to be this move.
+            bMove->move = static_cast<Move *>(*mIter)->GetCode();
+
+            // [Filled blank] Set the reply move to be the subBestMove's move.
+            bMove->replyMove = subBestMove.move;
+
+            if (ctx->collectPV)
+               SavePV(ctx, ply, *mIter);
+         }
+         // [Filled blank] Conditional: Black pushes the ceiling down.
+         else if (board->GetWhoseMove() == 0 && subBestMove.value < max) {
+            bMove->value = max = subBestMove.value;
+
+            // [Filled blank] Set the reply move to be the subBestMove
+            bMove->move = static_cast<Move *>(*mIter)->GetCode();
+
+            // [Filled blank] Set the reply move to be the subBestMove's move.
+            bMove->replyMove = subBestMove.move;
+
+            if (ctx->collectPV)
+               SavePV(ctx, ply, *mIter);
+         }
+
+         if (ctx->opts.trace)
+            ctx->opts.trace->Record(ply, minimaxLevel, *mIter, min, max,
+             subBestMove.value, subBestMove.numBoards);
+
+         if (dbg > 0) {
+            for (int cnt = minimaxLevel-1; cnt > 0; cnt--)
+               std::cout << "   ";
+            std::cout << "Move " << (std::string)**mIter << " nets "
+             << subBestMove.value << " min/max is " << min << "/" << max
+             << std::endl;
+         }
+
+         PHASE_TIMED(kApply, board->UndoLastMove());
+         bMove->numBoards += subBestMove.numBoards;
+      }
+
+      // A window closed by the first move tried is the mark of good
+      // move ordering.
+      if (min >= max && !ctx->stopped) {
+         ctx->stats.cutoffs++;
+         if (mIter == std::next(moves.begin()))
+            ctx->stats.firstCutoffs++;
+      }
+
+      // [Filled blank] Delete Move pointers contained in any unused nodes.
+      for (; mIter != moves.end(); mIter++)
+         delete static_cast<Move *>(*mIter);
+
+      // [Filled blank] From the loop before, a min/max limits collision doesn't
+      // return, but breaks instead (to provide time to clean up the
+      // GetAllMoves() call.  Thus, you have to ensure that the tTable isn't
+      // added if you had a min/max collision.
+      if (tTable && minimaxLevel >= SimpleAIPlayer::SAVE_LEVEL && min < max
+       && bMove->HasMove() && !ctx->stopped) {
+         Arena::Scope scope(tTable->GetArena());
+         PHASE_TIMER(kTable);
+
+         // [Filled blank] Insert the key->bestMove mapping into the map.
+         ins = tTable->insert(Book::value_type(key, *bMove));
+
+         // If you successfully inserted the key, then nil out the pointer to
+         // it before you accidentally delete it after this else{} finishes.
+         if (ins.second) {
+            key = 0;
+            ctx->stats.ttStores++;
+         }
+         // [Filled blank] "And, very importantly, we update the table
+         // even if it already has a key for the board you're computing, if
+         // your new computation is for a deeper lookahead minimaxLevel than
+         // the one in the tTable."
+         else if ((*ins.first).second.depth < minimaxLevel) {
+            (*ins.first).second = *bMove;
+            ctx->stats.ttStores++;
+         }
+         if (!ins.second)
+            ctx->stats.ttReplaceChecks++;
+      }
+   }
+   delete key;
+}
+
+// Return the value of *board, 'ply' halfmoves below the root, after any
+// pending captures play out, searching only capture moves for up to 'depth'
+// more halfmoves.  Where captures are optional, the player to move may
+// instead "stand pat" on GetValue.  As in SearchNode, player 0 maximizes,
+// values outside (min, max) are uninteresting, and boards and leaves are
+// counted in ctx->stats.  Adds the number of boards examined to *numBoards.
+// Once ctx->opts.cancel is cancelled, the value is not to be trusted.
+template <class B>
+long MinimaxT<B>::Quiesce(Context *ctx, B *board, int ply, int depth,
+ long min, long max, long *numBoards) {
+   std::list<Board::Move *> moves;
+   std::list<Board::Move *>::iterator mIter;
+   bool maximize = board->GetWhoseMove() == 0, forced;
+   long value, best;
+
+   forced = PHASE_TIMED(kMoveGen, board->GetCaptureMoves(&moves));
+   if (moves.size() == 0 || depth == 0) {
+      for (mIter = moves.begin(); mIter != moves.end(); mIter++)
+         delete static_cast<Move *>(*mIter);
+      ctx->stats.leafEvals++;
+      return PHASE_TIMED(kEval, board->GetValue());
+   }
+
+   if (forced)
+      best = maximize ? -Board::kWinVal : Board::kWinVal;
+   else {
+      best = PHASE_TIMED(kEval, board->GetValue());
+      ctx->stats.leafEvals++;
+      if (maximize && best > min)
+         min = best;
+      else if (!maximize && best < max)
+         max = best;
+   }
+
+   for (mIter = moves.begin(); min < max && mIter != moves.end()
+    && !ctx->Stopped(); mIter++) {
+      PHASE_TIMED(kApply, board->ApplyMove(*mIter));
+      (*numBoards)++;
+      ctx->stats.CountNode(ply + 1);
+      value = Quiesce(ctx, board, ply + 1, depth - 1, min, max, numBoards);
+      PHASE_TIMED(kApply, board->UndoLastMove());
+
+      if (maximize && value > best) {
+         best = value;
+         if (value > min)
+            min = value;
+      }
+      else if (!maximize && value < best) {
+         best = value;
+         if (value < max)
+            max = value;
+      }
+   }
+
+   for (; mIter != moves.end(); mIter++)
+      delete static_cast<Move *>(*mIter);
+
+   return best;
+}
+
+#endif
@@ -12,7 +12,7 @@ class FString : public std::string {
 public:
    FString(char *fmt, ...) {
       static const int bufLen = 1024;
-      static char buf[bufLen];
+      char buf[bufLen];      // Not static, so threads may format at once
       va_list args;
 
       va_start(args, fmt);
@@ -46,7 +46,7 @@ inline int InOrder(const T lo, const T x, const T hi)
  {return !(x < lo || hi < x);}
 
 template <class T>
-inline int InRange(const T lo, const T x, const T hi)
+constexpr int InRange(const T lo, const T x, const T hi)
  {return !(x < lo) && x < hi;}
 
 template <class T>
@@ -80,6 +80,28 @@ typedef unsigned int uint;
 typedef unsigned short ushort;
 typedef char *CStr;
 
+// Marsaglia's xorshift64* generator: a few shifts and a multiply per number,
+// with all its state in one word, for random playouts where rand() would be
+// too slow and too shared.  Not for anything needing quality randomness.
+class XorShift {
+public:
+   XorShift(unsigned long long seed = 1)
+    : mState(seed ? seed : 0x9E3779B97F4A7C15ULL) {}
+
+   unsigned long long Next() {
+      mState ^= mState >> 12;
+      mState ^= mState << 25;
+      mState ^= mState >> 27;
+      return mState * 0x2545F4914F6CDD1DULL;
+   }
+
+   // Return a number in [0, n), by scaling rather than division.
+   uint Below(uint n) {return (uint)((Next() >> 32) * n >> 32);}
+
+private:
+   unsigned long long mState;
+};
+
 #ifndef LITTLE_ENDIAN
 
 inline ushort EndianXfer(ushort val) {return val >> 8 | val << 8;}
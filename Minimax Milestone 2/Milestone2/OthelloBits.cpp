@@ -0,0 +1,29 @@
+#include "OthelloBits.h"
+
+constexpr int OthelloBits::mShifts[kNumDirs];
+constexpr OthelloBits::Bits OthelloBits::mEdgeMasks[kNumDirs];
+
+// Build the ray table.  Run by the compiler, once, for mTables.
+constexpr OthelloBits::Tables OthelloBits::MakeTables() {
+   Tables tbl = {};
+   Bits cursor = 0;
+   int sq = 0, dir = 0;
+
+   for (sq = 0; sq < kDim * kDim; sq++)
+      for (dir = 0; dir < kNumDirs; dir++)
+         for (cursor = Shift(1ULL << sq, dir); cursor;
+          cursor = Shift(cursor, dir))
+            tbl.rays[sq][dir] |= cursor;
+
+   return tbl;
+}
+
+const OthelloBits::Tables OthelloBits::mTables = MakeTables();
+
+// Bit index lookup for LowSquare, by the De Bruijn multiplication method.
+const int OthelloBits::mDeBruijn[64] = {
+    0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+   62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+   63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+   46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6
+};
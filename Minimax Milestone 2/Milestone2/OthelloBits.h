@@ -0,0 +1,112 @@
+#ifndef OTHELLOBITS_H
+#define OTHELLOBITS_H
+
+// Bitboard primitives for Othello: each side's pieces as one 64-bit mask,
+// with square (row, col) at bit row*kDim + col.  OthelloSolver searches
+// with these, and OthelloBoard plays its random playouts with them.  The
+// functions are inline, since the callers' inner loops are built of them.
+class OthelloBits {
+public:
+   typedef unsigned long long Bits;
+
+   enum {kDim = 8, kNumDirs = 8};
+
+   static constexpr Bits Shift(Bits bits, int dir) {
+      return (mShifts[dir] > 0 ? bits << mShifts[dir] 
+       : bits >> -mShifts[dir]) & mEdgeMasks[dir];
+   }
+
+   // Return the squares where the owner of 'mine' may move.
+   static Bits GetMoves(Bits mine, Bits theirs) {
+      Bits moves = 0, empty = ~(mine | theirs), run;
+      int dir, step;
+
+      for (dir = 0; dir < kNumDirs; dir++) {
+         run = Shift(mine, dir) & theirs;
+         for (step = 0; step < kDim - 3; step++)
+            run |= Shift(run, dir) & theirs;
+         moves |= Shift(run, dir) & empty;
+      }
+      return moves;
+   }
+
+   // Return the opponent pieces flipped by the owner of 'mine' playing at
+   // 'sq', which must be empty.  None are flipped if the move is illegal.
+   // Along each ray from 'sq', the run of 'theirs' ends at the nearest
+   // other square, which is the lowest such bit of a ray running to higher
+   // squares, and the highest of one running to lower squares.  The run
+   // flips if that square is one of 'mine'.
+   static Bits GetFlips(Bits mine, Bits theirs, int sq) {
+      const Bits *rays = mTables.rays[sq];
+      Bits flips = 0, ends, end;
+      int dir;
+
+      for (dir = 0; dir < kNumDirs; dir++) {
+         if ((ends = rays[dir] & ~theirs) == 0)
+            continue;
+         if (mShifts[dir] > 0) {
+            end = ends & (0 - ends);
+            if (end & mine)
+               flips |= rays[dir] & (end - 1);
+         }
+         else {
+            end = HighBit(ends);
+            if (end & mine)
+               flips |= rays[dir] & ~(end | (end - 1));
+         }
+      }
+      return flips;
+   }
+
+   static int Count(Bits bits) {
+      bits = bits - (bits >> 1 & 0x5555555555555555ULL);
+      bits = (bits & 0x3333333333333333ULL)
+       + (bits >> 2 & 0x3333333333333333ULL);
+      bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+      return (int)(bits * 0x0101010101010101ULL >> 56);
+   }
+
+   static int LowSquare(Bits bits) {
+      return mDeBruijn[(bits & (0 - bits)) * 0x03F79D71B4CB0A89ULL >> 58];
+   }
+
+   // Return just the highest 1-bit of 'bits', which must not be 0.
+   static Bits HighBit(Bits bits) {
+      bits |= bits >> 1;
+      bits |= bits >> 2;
+      bits |= bits >> 4;
+      bits |= bits >> 8;
+      bits |= bits >> 16;
+      bits |= bits >> 32;
+      return bits ^ bits >> 1;
+   }
+
+protected:
+   // Squares along each direction from each square, up to the edge, not
+   // counting the square itself.
+   struct Tables {
+      Bits rays[kDim * kDim][kNumDirs];
+   };
+
+   // East, west, south, north, southeast, southwest, northeast, northwest.
+   // A shift with an eastward component must not land in column 0 (that
+   // would be a wrap from column kDim-1 of another row), nor a westward one
+   // in column kDim-1.
+   static constexpr int mShifts[kNumDirs] = {1, -1, 8, -8, 9, 7, -7, -9};
+
+   // Squares a shift may land on
+   static constexpr Bits mEdgeMasks[kNumDirs] = {
+      0xFEFEFEFEFEFEFEFEULL, 0x7F7F7F7F7F7F7F7FULL,
+      0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL,
+      0xFEFEFEFEFEFEFEFEULL, 0x7F7F7F7F7F7F7F7FULL,
+      0xFEFEFEFEFEFEFEFEULL, 0x7F7F7F7F7F7F7F7FULL
+   };
+
+   static const Tables mTables;
+   static const int mDeBruijn[64];
+
+   // Build mTables.
+   static constexpr Tables MakeTables();
+};
+
+#endif
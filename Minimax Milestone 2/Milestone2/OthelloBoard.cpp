@@ -6,25 +6,35 @@
 #include "OthelloMove.h"
 #include "MyLib.h"
 #include "BasicKey.h"
+#include "OthelloBits.h"
+#include "MinimaxEngine.h"
 
 using namespace std;
 
-short OthelloBoard::mWeights[dim][dim] = {
-   {16, 0, 8, 8, 8, 8, 0, 16},
-   { 0, 0, 0, 0, 0, 0, 0,  0},
-   { 8, 0, 1, 1, 1, 1, 0,  8},
-   { 8, 0, 1, 1, 1, 1, 0,  8},
-   { 8, 0, 1, 1, 1, 1, 0,  8},
-   { 8, 0, 1, 1, 1, 1, 0,  8},
-   { 0, 0, 0, 0, 0, 0, 0,  0},
-   {16, 0, 8, 8, 8, 8, 0, 16}
-};
+// Corner, side, near-side and inner weights.
+OthelloBoard::Rules OthelloBoard::mDefaultRules = {16, 8, 0, 1};
 
-OthelloBoard::Direction OthelloBoard::mDirs[mNumDirs] = {
-   {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}, {1, 0}, {1, 1}
-};
+// Build the ray table.  Run by the compiler, once, for mTables.
+constexpr OthelloBoard::Tables OthelloBoard::MakeTables() {
+   Tables tbl = {};
+   int row = 0, col = 0, dNdx = 0, testRow = 0, testCol = 0;
 
-set<OthelloBoard *> OthelloBoard::mRoster;
+   for (row = 0; row < dim; row++)
+      for (col = 0; col < dim; col++)
+         for (dNdx = 0; dNdx < mNumDirs; dNdx++) {
+            Ray &ray = tbl.rays[row * dim + col][dNdx];
+
+            for (testRow = row + mDirs[dNdx].rDelta, 
+             testCol = col + mDirs[dNdx].cDelta; InBounds(testRow, testCol);
+             testRow += mDirs[dNdx].rDelta, testCol += mDirs[dNdx].cDelta)
+               ray.squares[ray.length++] = testRow * dim + testCol;
+         }
+
+   return tbl;
+}
+
+constexpr OthelloBoard::Direction OthelloBoard::mDirs[mNumDirs];
+const OthelloBoard::Tables OthelloBoard::mTables = MakeTables();
 
 BoardClass OthelloBoard::mClass("OthelloBoard",
                                 &CreateOthelloBoard,
@@ -34,6 +44,8 @@ BoardClass OthelloBoard::mClass("OthelloBoard",
                                 &OthelloBoard::SetOptions,
                                 &OthelloBoard::GetOptions);
 
+MinimaxT<OthelloBoard> OthelloBoard::mMinimax("OthelloBoard");
+
 OthelloBoard::OthelloBoard() : mNextMove(mBPiece), mPassCount(0), mWeight(0) {
    int row, col;
 
@@ -43,12 +55,11 @@ OthelloBoard::OthelloBoard() : mNextMove(mBPiece), mPassCount(0), mWeight(0) {
 
    mBoard[dim/2-1][dim/2-1] = mBoard[dim/2][dim/2] = mWPiece;
    mBoard[dim/2-1][dim/2] = mBoard[dim/2][dim/2-1] = mBPiece;
-   mRoster.insert(this);
+   SetRules(&mDefaultRules);
 }
 
 OthelloBoard::~OthelloBoard() {
    ClearHistory();
-   mRoster.erase(this);
 }
 
 long OthelloBoard::GetValue() const {
@@ -65,11 +76,26 @@ long OthelloBoard::GetValue() const {
    }
 }
 
+// Walk the ray while it runs over the other player's pieces.  The
+// squares of mBoard are taken as one flat array, as the rays number them.
+inline int OthelloBoard::FlipCount(const Ray *ray) const {
+   const char *board = *mBoard;
+   int step = 0;
+
+   while (step < ray->length && board[ray->squares[step]] == -mNextMove)
+      step++;
+
+   return step < ray->length && board[ray->squares[step]] == mNextMove
+    ? step : 0;
+}
+
 void OthelloBoard::ApplyMove(Move *move)
 {
-   OthelloMove *om = dynamic_cast<OthelloMove *>(move);
-   int dNdx, row, col, switched;
-   Direction *dir;
+   OthelloMove *om = static_cast<OthelloMove *>(move);
+   char *board = *mBoard;
+   const short *weights = *mWeights;
+   const Ray *ray;
+   int dNdx, flip, switched;
 
    if (om->IsPass()) {
       mPassCount++;
@@ -81,28 +107,15 @@ void OthelloBoard::ApplyMove(Move *move)
       mBoard[om->mRow][om->mCol] = mNextMove;
       mWeight += mNextMove * mWeights[om->mRow][om->mCol];
 
-      for (dNdx = 0; dNdx < mNumDirs; dNdx++) {
-         dir = mDirs + dNdx;
-         row = om->mRow;
-         col = om->mCol;
-
-         do {
-            row += dir->rDelta;
-            col += dir->cDelta;
-         } while (InBounds(row, col) && mBoard[row][col] == -mNextMove);
-         
-         if (InBounds(row, col) && mBoard[row][col] == mNextMove) {
-            for (switched = 0, row -= dir->rDelta, col -= dir->cDelta;
-             row != om->mRow || col != om->mCol;
-             row -= dir->rDelta, col -= dir->cDelta) {
-               mBoard[row][col] = mNextMove;
-               mWeight += 2 * mNextMove * mWeights[row][col];
-               switched++;
+      ray = mTables.rays[om->mRow * dim + om->mCol];
+      for (dNdx = 0; dNdx < mNumDirs; dNdx++, ray++)
+         if ((switched = FlipCount(ray)) > 0) {
+            for (flip = 0; flip < switched; flip++) {
+               board[ray->squares[flip]] = mNextMove;
+               mWeight += 2 * mNextMove * weights[ray->squares[flip]];
             }
-            if (switched > 0)
-               om->AddFlipSet(OthelloMove::FlipSet(switched, dir));
+            om->AddFlipSet(OthelloMove::FlipSet(switched, mDirs + dNdx));
          }
-      }
       assert(om->GetFlipSets().size() > 0);
       mPassCount = 0;
    }
@@ -111,9 +124,12 @@ void OthelloBoard::ApplyMove(Move *move)
 }
 
 void OthelloBoard::UndoLastMove() {
-   OthelloMove *om = dynamic_cast<OthelloMove *>(mMoveHist.back());
+   OthelloMove *om = static_cast<OthelloMove *>(mMoveHist.back());
    int baseRow = om->mRow, baseCol = om->mCol;
-   int row, col, flip;
+   char *board = *mBoard;
+   const short *weights = *mWeights;
+   const Ray *ray;
+   int flip;
    OthelloMove::FlipSet flipSet;
    OthelloMove::FlipList::iterator itr;
 
@@ -127,13 +143,10 @@ void OthelloBoard::UndoLastMove() {
       mWeight += mNextMove * mWeights[baseRow][baseCol];
       for (itr = om->mFlipSets.begin(); itr != om->mFlipSets.end(); itr++) {
          flipSet = *itr;
-         row = baseRow + flipSet.dir->rDelta;
-         col = baseCol + flipSet.dir->cDelta;
+         ray = mTables.rays[baseRow * dim + baseCol] + (flipSet.dir - mDirs);
          for (flip = 0; flip < flipSet.count; flip++) {
-            mBoard[row][col] = mNextMove;
-            mWeight += 2*mNextMove*mWeights[row][col];
-            row += flipSet.dir->rDelta;
-            col += flipSet.dir->cDelta;
+            board[ray->squares[flip]] = mNextMove;
+            mWeight += 2*mNextMove*weights[ray->squares[flip]];
          }
       }
    }
@@ -143,8 +156,8 @@ void OthelloBoard::UndoLastMove() {
 }
 
 void OthelloBoard::GetAllMoves(list<Move *> *moves) const {
-   int testRow, testCol, row, col, dNdx, steps;
-   Direction *dir;
+   int row, col, dNdx;
+   const Ray *ray;
 
    assert(moves->size() == 0);
 
@@ -153,22 +166,9 @@ void OthelloBoard::GetAllMoves(list<Move *> *moves) const {
          if (mBoard[row][col] != 0)
             continue;
 
-         for (dNdx = 0; dNdx < mNumDirs; dNdx++) {
-            dir = mDirs + dNdx;
-            testRow = row;
-            testCol = col;
-            steps = 0;
-            do {
-               testRow += dir->rDelta;
-               testCol += dir->cDelta;
-               steps++;
-            } while (InBounds(testRow, testCol)
-             && mBoard[testRow][testCol] == -mNextMove);
-      
-            if (InBounds(testRow, testCol)
-             && mBoard[testRow][testCol] == mNextMove && steps >= 2)
-               break;
-         }
+         ray = mTables.rays[row * dim + col];
+         for (dNdx = 0; dNdx < mNumDirs && FlipCount(ray + dNdx) == 0; dNdx++)
+            ;
          if (dNdx < mNumDirs)
             moves->push_back(new OthelloMove(row, col));
       }
@@ -177,6 +177,45 @@ void OthelloBoard::GetAllMoves(list<Move *> *moves) const {
       moves->push_back(new OthelloMove(-1, -1));
 }
 
+// Play out on bitboards (see OthelloBits), passing whenever the player to 
+// move has no square, until two passes in a row end the game.  A game cut
+// off unfinished goes to whoever has more pieces.
+int OthelloBoard::Playout(XorShift *rng, int maxPlies) {
+   OthelloBits::Bits mine = 0, theirs = 0, moves, flips, temp;
+   int row, col, plies, pick, passes = mPassCount, diff;
+   bool blackMoves = mNextMove == mBPiece;
+
+   for (row = 0; row < dim; row++)
+      for (col = 0; col < dim; col++)
+         if (mBoard[row][col] == mNextMove)
+            mine |= 1ULL << (row * dim + col);
+         else if (mBoard[row][col] == -mNextMove)
+            theirs |= 1ULL << (row * dim + col);
+
+   for (plies = 0; plies < maxPlies && passes < 2; plies++) {
+      if ((moves = OthelloBits::GetMoves(mine, theirs)) == 0)
+         passes++;
+      else {
+         for (pick = rng->Below(OthelloBits::Count(moves)); pick--; )
+            moves &= moves - 1;
+         pick = OthelloBits::LowSquare(moves);
+         flips = OthelloBits::GetFlips(mine, theirs, pick);
+         mine |= flips | 1ULL << pick;
+         theirs &= ~flips;
+         passes = 0;
+      }
+      temp = mine;
+      mine = theirs;
+      theirs = temp;
+      blackMoves = !blackMoves;
+   }
+
+   diff = OthelloBits::Count(mine) - OthelloBits::Count(theirs);
+   if (!blackMoves)
+      diff = -diff;
+   return diff > 0 ? 1 : diff < 0 ? -1 : 0;
+}
+
 Board::Move *OthelloBoard::CreateMove() const {
    return new OthelloMove(0, 0);
 }
@@ -188,22 +227,23 @@ Board *OthelloBoard::Clone() const {
    for (itr = rtn->mMoveHist.begin(); itr != rtn->mMoveHist.end(); itr++)
       *itr = (*itr)->Clone();
 
-   mRoster.insert(rtn);
    return rtn;
 }
 
+// Each square takes sqrShift bits, keyRows rows to a long, and the player
+// to move takes the last long: 129 bits in all, in three longs.
 Board::Key *OthelloBoard::GetKey() const {
-   BasicKey<5> *rtn = new BasicKey<5>();
+   ulong vals[keyLongs] = {};
    int row, col;
-   ulong *vals = rtn->vals;
 
    for (row = 0; row < dim; row++)
       for (col = 0; col < dim; col++)
-         vals[row/2] = vals[row/2] << sqrShift | mBoard[row][col] + 1;
+         vals[row/keyRows] = vals[row/keyRows] << sqrShift
+          | (mBoard[row][col] + 1);
 
-   vals[row/2] = mNextMove + 1;
+   vals[row/keyRows] = mNextMove + 1;
 
-   return rtn;
+   return new BasicKey<keyLongs>(vals);
 }
 
 istream &OthelloBoard::Read(istream &is)
@@ -234,7 +274,7 @@ istream &OthelloBoard::Read(istream &is)
       }
    }
 
-   SetOptions(&temp);
+   SetRules(&temp);
 
    is.read(&mNextMove, sizeof(mNextMove));
    is.read(&mPassCount, sizeof(mPassCount));
@@ -256,14 +296,13 @@ ostream &OthelloBoard::Write(ostream &os) const
    unsigned char sz = mMoveHist.size();
    unsigned short rowBits;
    list<Move *>::const_iterator itr;
-   Rules *rls = reinterpret_cast<Rules *>(GetOptions());
+   Rules rls = mRules;
 
-   rls->cornerWgt = EndianXfer(rls->cornerWgt);
-   rls->sideWgt = EndianXfer(rls->sideWgt);
-   rls->nearSideWgt = EndianXfer(rls->nearSideWgt);
-   rls->innerWgt = EndianXfer(rls->innerWgt);
-   os.write((char *)rls, sizeof(Rules));
-   delete rls;
+   rls.cornerWgt = EndianXfer(rls.cornerWgt);
+   rls.sideWgt = EndianXfer(rls.sideWgt);
+   rls.nearSideWgt = EndianXfer(rls.nearSideWgt);
+   rls.innerWgt = EndianXfer(rls.innerWgt);
+   os.write((char *)&rls, sizeof(Rules));
 
    for (row = 0; row < dim; row++) {
       for (col = rowBits = 0; col < dim; col++)
@@ -303,39 +342,40 @@ void OthelloBoard::ClearHistory()
    mMoveHist.clear();
 }
 
-void *OthelloBoard::GetOptions()
+void *OthelloBoard::GetRules() const
 {
-   Rules *rtn = new Rules;
-   short (*mWeights)[OthelloBoard::dim] = OthelloBoard::mWeights;
-
-   rtn->cornerWgt = mWeights[0][0];
-   rtn->sideWgt = mWeights[0][2];
-   rtn->nearSideWgt = mWeights[1][1];
-   rtn->innerWgt = mWeights[2][2];
-
-   return rtn;
+   return new Rules(mRules);
 }
 
-// They write
-void OthelloBoard::SetOptions(const void *data)
+// Rebuild this board's square weights from *data, and reweigh the board.
+void OthelloBoard::SetRules(const void *data)
 {
-   const Rules *rules = reinterpret_cast<const Rules *>(data);
-   int row, col, dim = OthelloBoard::dim;
-   set<OthelloBoard *>::iterator itr;
+   int row, col;
 
+   mRules = *reinterpret_cast<const Rules *>(data);
    for (row = 0; row < dim; row++) {
       for (col = 0; col < dim; col++)
          if (row == 1 || col == 1 || row == dim-2 || col == dim-2)
-            mWeights[row][col] = rules->nearSideWgt;
+            mWeights[row][col] = mRules.nearSideWgt;
          else if (row == 0 || col == 0 || row == dim-1 || col == dim-1)
-            mWeights[row][col] = rules->sideWgt;
+            mWeights[row][col] = mRules.sideWgt;
          else
-            mWeights[row][col] = rules->innerWgt;
+            mWeights[row][col] = mRules.innerWgt;
 
    }
    mWeights[0][0] = mWeights[0][dim-1] = mWeights[dim-1][0]
-    = mWeights[dim-1][dim-1] = rules->cornerWgt;
+    = mWeights[dim-1][dim-1] = mRules.cornerWgt;
+
+   RecalcWeight();
+}
+
+void *OthelloBoard::GetOptions()
+{
+   return new Rules(mDefaultRules);
+}
 
-   for (itr = mRoster.begin(); itr != mRoster.end(); itr++)
-      (*itr)->RecalcWeight();
+// Existing boards keep their Rules; only boards created afterward see these.
+void OthelloBoard::SetOptions(const void *data)
+{
+   mDefaultRules = *reinterpret_cast<const Rules *>(data);
 }
@@ -2,13 +2,13 @@
 #define OTHELLOBOARD_H
 
 #include <iostream>
-#include <set>
 #include "MyLib.h"
 #include "Board.h"
 
 class OthelloMove;
+template <class B> class MinimaxT;
 
-class OthelloBoard : public Board {
+class OthelloBoard final : public Board {
 public:
    friend class OthelloMove;
 
@@ -35,6 +35,7 @@ public:
    void ApplyMove(Move *);
    void UndoLastMove();
    void GetAllMoves(std::list<Move *> *) const;
+   int Playout(XorShift *rng, int maxPlies);
    Move *CreateMove() const;
    int GetWhoseMove() const {return mNextMove == mWPiece;}
    const std::list<const Move *> &GetMoveHist() const 
@@ -43,10 +44,12 @@ public:
 
    Board *Clone() const;
    Key *GetKey() const;
+   void *GetRules() const;
+   void SetRules(const void *rules);
 
-   // Option accessor/mutator.  GetOptions returns dynamically allocated
-   // object representing options. SetOptions takes similar object.  Caller
-   // owns object in both cases.
+   // Option accessor/mutator for the default Rules given to new boards.
+   // GetOptions returns dynamically allocated object representing options.
+   // SetOptions takes similar object.  Caller owns object in both cases.
    static void *GetOptions();
    static void SetOptions(const void *opts);
 
@@ -55,23 +58,53 @@ public:
 protected:
    enum {mNumDirs = 8, squareCount = 64, sqrShift = 2, sqrMask = 0x3};
 
+   // Rows of squares filling each long of a key, and the longs in a key:
+   // those for the squares, plus one for the player to move.
+   enum {keyRows = 64 / (dim * sqrShift), keyLongs = dim / keyRows + 1};
+
+   // The squares along one direction from a square, nearest first, up to
+   // the edge.  Squares are numbered row*dim + col, indexing mBoard and
+   // mWeights as flat arrays.
+   struct Ray {
+      char length;             // Number of squares in the ray
+      char squares[dim - 1];
+   };
+
+   // Rays from each square, in mDirs order, built at compile time by
+   // MakeTables.
+   struct Tables {
+      Ray rays[squareCount][mNumDirs];
+   };
+
    std::istream &Read(std::istream &);
    std::ostream &Write(std::ostream &) const;
    void RecalcWeight();  // Recalculate current weight of this OthelloBoard.
    void ClearHistory();  // Clear out move history of this board.
 
+   // Return how many pieces of the player not moving lie along 'ray' and
+   // are closed off by one of the mover's, so that a move at the ray's 
+   // origin would flip them.
+   inline int FlipCount(const Ray *ray) const;
+
+   static constexpr Tables MakeTables();
+
    static BoardClass mClass;
-   static std::set<OthelloBoard *> mRoster;
-   static Direction mDirs[mNumDirs];
-   static short mWeights[dim][dim];
+   static MinimaxT<OthelloBoard> mMinimax;  // Search compiled for this class
+   static constexpr Direction mDirs[mNumDirs] = {
+      {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}, {1, 0}, {1, 1}
+   };
+   static const Tables mTables;
+   static Rules mDefaultRules;   // Rules copied by each new board
    
-   static bool InBounds(int row, int col)
+   static constexpr bool InBounds(int row, int col)
     {return InRange<short>(0, row, dim) && InRange<short>(0, col, dim);}
 
    char mBoard[dim][dim];       // Current state of board
    char mNextMove;              // Whose move is next (mWPiece or mBPiece)
    char mPassCount;             // How many pass moves have just been made
    short mWeight;               // Current board weight.
+   Rules mRules;                // This board's weighting rules
+   short mWeights[dim][dim];    // Square weights derived from mRules
    std::list<Move *> mMoveHist; // History of moves thus far.
 
 private:
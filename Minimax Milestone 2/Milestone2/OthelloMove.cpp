@@ -1,29 +1,28 @@
 #include "MyLib.h"
+#include "Arena.h"
+#include "SlabPool.h"
 #include "OthelloMove.h"
 #include "OthelloBoard.h"
 
 using namespace std;
 
-vector<OthelloMove *> OthelloMove::mFreeList;
 
+// Allocate from the current search's Arena, if any, or else the pool.
 void *OthelloMove::operator new(size_t sz) {
-   void *temp;
+   void *temp = Arena::AllocCurrent(sz);
 
-   if (mFreeList.size()) {
-      temp = mFreeList.back();
-      mFreeList.pop_back();
-   } else {
-      temp = ::new char[sz];
-   }
+   if (!temp)
+      temp = SlabPool<OthelloMove>::Alloc();
 
-   mOutstanding++;
+   MemStats::Alloc(MemStats::kMove, sizeof(OthelloMove));
    return temp;
 }
 
 void OthelloMove::operator delete(void *p) {
-   mFreeList.push_back((OthelloMove *)p);
+   if (!Arena::FreeCurrent(p, sizeof(OthelloMove)))
+      SlabPool<OthelloMove>::Free(p);
 
-   mOutstanding--;
+   MemStats::Free(MemStats::kMove, sizeof(OthelloMove));
 }
 
 bool OthelloMove::operator==(const Board::Move &rhs) const {
@@ -64,6 +63,24 @@ void OthelloMove::operator=(const string &src) {
    mCol = (char)tCol;
 }
 
+uint OthelloMove::GetCode() const {
+   return (mRow & bitMask) << bitShift | (mCol & bitMask);
+}
+
+void OthelloMove::SetCode(uint code) {
+   short tRow = code >> bitShift, tCol = code & bitMask;
+
+   if (code == (bitMask << bitShift | bitMask))
+      tRow = tCol = -1;
+   else if (!InRange<short>(0, tRow, OthelloBoard::dim)
+    || !InRange<short>(0, tCol, OthelloBoard::dim))
+      throw BaseException(FString("Bad Othello move code: %X", code));
+
+   mRow = (char)tRow;
+   mCol = (char)tCol;
+   mFlipSets.clear();
+}
+
 Board::Move *OthelloMove::Clone() const {
    return new OthelloMove(*this);
 }
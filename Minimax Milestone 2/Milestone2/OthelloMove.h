@@ -6,7 +6,7 @@
 #include <vector>
 #include "OthelloBoard.h"
 
-class OthelloMove : public Board::Move {
+class OthelloMove final : public Board::Move {
 public:
    // Flipset represents a "run" of flips in a given direction.
    struct FlipSet {
@@ -33,6 +33,8 @@ public:
    bool operator<(const Board::Move &rhs) const;
    operator std::string() const;
    void operator=(const std::string &src);
+   uint GetCode() const;
+   void SetCode(uint code);
    Board::Move *Clone() const;
 
    bool IsPass() const {return mRow == -1 && mCol == -1;}
@@ -47,13 +49,18 @@ protected:
    std::istream &Read(std::istream &is);
    std::ostream &Write(std::ostream &) const;
 
+   // A code holds the row in its high nybble and the column in its low one,
+   // each masked to bitMask, so a pass is 0xFF.
    enum {bitShift = 4, bitMask = 0xF};
 
    char mRow;
    char mCol;
    FlipList mFlipSets;
 
-   static std::vector<OthelloMove *> mFreeList;
+};
+
+template <> struct GameTraits<OthelloBoard> {
+   typedef OthelloMove Move;
 };
 
 #endif
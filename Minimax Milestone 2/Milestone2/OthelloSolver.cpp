@@ -0,0 +1,205 @@
+#include <assert.h>
+#include "OthelloSolver.h"
+#include "OthelloBoard.h"
+#include "OthelloMove.h"
+
+using namespace std;
+
+OthelloSolver OthelloSolver::mSolver;
+
+const OthelloSolver::Bits OthelloSolver::mQuadrants[4] = {
+   0x000000000F0F0F0FULL, 0x00000000F0F0F0F0ULL,
+   0x0F0F0F0F00000000ULL, 0xF0F0F0F000000000ULL
+};
+
+int OthelloSolver::GetRemaining(const Board *brd) const {
+   const OthelloBoard *ob = dynamic_cast<const OthelloBoard *>(brd);
+   int row, col, empties = 0;
+
+   for (row = 0; row < OthelloBoard::dim; row++)
+      for (col = 0; col < OthelloBoard::dim; col++)
+         empties += ob->GetSquare(row, col) == 0;
+
+   return empties;
+}
+
+long OthelloSolver::Solve(Board *brd, BestMove *res) const {
+   const OthelloBoard *ob = dynamic_cast<const OthelloBoard *>(brd);
+   char mover = brd->GetWhoseMove() ? OthelloBoard::mWPiece 
+    : OthelloBoard::mBPiece;
+   Bits mine = 0, theirs = 0;
+   int row, col, sq, score, bestSq, replySq;
+   long nodes = 0;
+   list<Board::Move *> moves;
+   list<Board::Move *>::iterator mIter;
+
+   // Let the board itself say whether the game is over, since a board may
+   // have pass moves left even with no squares to play.
+   brd->GetAllMoves(&moves);
+   for (mIter = moves.begin(); mIter != moves.end(); mIter++)
+      delete *mIter;
+
+   for (row = 0; row < OthelloBoard::dim; row++)
+      for (col = 0; col < OthelloBoard::dim; col++) {
+         sq = row * OthelloBoard::dim + col;
+         if (ob->GetSquare(row, col) == mover)
+            mine |= 1ULL << sq;
+         else if (ob->GetSquare(row, col) == -mover)
+            theirs |= 1ULL << sq;
+      }
+
+   res->Clear(GetRemaining(brd), 1);
+   if (moves.size() == 0) {
+      bestSq = kGameOver;
+      score = Count(mine) - Count(theirs);
+   }
+   else
+      score = Negamax(mine, theirs, -kInf, kInf, false, &bestSq, &replySq,
+       &nodes);
+   if (brd->GetWhoseMove())
+      score = -score;
+
+   if (bestSq != kGameOver)
+      res->move = (bestSq == kPass ? OthelloMove(-1, -1) : OthelloMove(
+       bestSq / OthelloBoard::dim, bestSq % OthelloBoard::dim)).GetCode();
+   if (bestSq != kGameOver && replySq != kGameOver)
+      res->replyMove = (replySq == kPass ? OthelloMove(-1, -1) : OthelloMove(
+       replySq / OthelloBoard::dim, replySq % OthelloBoard::dim)).GetCode();
+
+   res->value = score > 0 ? Board::kWinVal : score < 0 ? -Board::kWinVal : 0;
+   res->numBoards += nodes;
+
+   return score;
+}
+
+// Return the final piece difference, from the view of the owner of 'mine' (to
+// move), with values outside (alpha, beta) meaning only "at most alpha" or 
+// "at least beta".  'passed' means the opponent just passed.  Add the number
+// of boards examined to *nodes.  If bestSq is non-NULL, also return there the
+// best move's square (or kPass, or kGameOver), and likewise the best reply
+// to it in *replySq if that is non-NULL.
+int OthelloSolver::Negamax(Bits mine, Bits theirs, int alpha, int beta,
+ bool passed, int *bestSq, int *replySq, long *nodes) {
+   Bits moves = GetMoves(mine, theirs), flips, placed;
+   int order[kMaxMoves], mobility[kMaxMoves], numMoves = 0;
+   int ndx, sq, score, best = -kInf, childSq, *childPtr;
+
+   if (!bestSq && Count(~(mine | theirs)) <= kShallow)
+      return SolveShallow(mine, theirs, alpha, beta, passed, nodes);
+
+   childPtr = replySq ? &childSq : NULL;
+
+   if (!moves) {
+      if (passed) {
+         if (bestSq)
+            *bestSq = kGameOver;
+         return Count(mine) - Count(theirs);
+      }
+      (*nodes)++;
+      score = -Negamax(theirs, mine, -beta, -alpha, true, childPtr, NULL,
+       nodes);
+      if (bestSq)
+         *bestSq = kPass;
+      if (replySq)
+         *replySq = childSq;
+      return score;
+   }
+
+   // Fastest-first: order moves by how few replies they leave the opponent.
+   for (; moves; moves &= moves - 1) {
+      sq = LowSquare(moves);
+      flips = GetFlips(mine, theirs, sq);
+      score = Count(GetMoves(theirs & ~flips, mine | flips | 1ULL << sq));
+      for (ndx = numMoves++; ndx > 0 && mobility[ndx-1] > score; ndx--) {
+         order[ndx] = order[ndx-1];
+         mobility[ndx] = mobility[ndx-1];
+      }
+      order[ndx] = sq;
+      mobility[ndx] = score;
+   }
+
+   for (ndx = 0; ndx < numMoves && alpha < beta; ndx++) {
+      sq = order[ndx];
+      flips = GetFlips(mine, theirs, sq);
+      placed = flips | 1ULL << sq;
+      (*nodes)++;
+      score = -Negamax(theirs & ~flips, mine | placed, -beta, -alpha, false,
+       childPtr, NULL, nodes);
+
+      if (score > best) {
+         best = score;
+         if (bestSq)
+            *bestSq = sq;
+         if (replySq)
+            *replySq = childSq;
+         if (score > alpha)
+            alpha = score;
+      }
+   }
+
+   return best;
+}
+
+// As Negamax, for boards with at most kShallow empty squares.  Rather than
+// generating moves, try each empty square in turn, those in quadrants with
+// an odd number of empties first: there the player moving may well get the
+// last move of the region.
+int OthelloSolver::SolveShallow(Bits mine, Bits theirs, int alpha, int beta,
+ bool passed, long *nodes) {
+   Bits empty = ~(mine | theirs), odd = 0, tries, flips;
+   int quad, round, sq, score, best = -kInf;
+   bool moved = false;
+
+   if (!(empty & (empty - 1)))
+      return empty ? SolveLast(mine, theirs, LowSquare(empty), nodes)
+       : Count(mine) - Count(theirs);
+
+   for (quad = 0; quad < 4; quad++)
+      if (Count(empty & mQuadrants[quad]) & 1)
+         odd |= mQuadrants[quad];
+
+   for (round = 0; round < 2; round++) {
+      tries = empty & (round ? ~odd : odd);
+      for (; tries; tries &= tries - 1) {
+         sq = LowSquare(tries);
+         if (!(flips = GetFlips(mine, theirs, sq)))
+            continue;
+
+         moved = true;
+         (*nodes)++;
+         score = -SolveShallow(theirs & ~flips, mine | flips | 1ULL << sq,
+          -beta, -alpha, false, nodes);
+         if (score > best) {
+            best = score;
+            if (score > alpha && (alpha = score) >= beta)
+               return best;
+         }
+      }
+   }
+
+   if (!moved) {
+      if (passed)
+         return Count(mine) - Count(theirs);
+      (*nodes)++;
+      return -SolveShallow(theirs, mine, -beta, -alpha, true, nodes);
+   }
+   return best;
+}
+
+// Return the final piece difference, from the view of the owner of 'mine', 
+// with only square 'sq' left empty.  Whoever can play there, the player to 
+// move first, does so, and the game ends.
+int OthelloSolver::SolveLast(Bits mine, Bits theirs, int sq, long *nodes) {
+   Bits flips;
+   int diff = Count(mine) - Count(theirs);
+
+   if ((flips = GetFlips(mine, theirs, sq)) != 0) {
+      (*nodes)++;
+      return diff + 2 * Count(flips) + 1;
+   }
+   if ((flips = GetFlips(theirs, mine, sq)) != 0) {
+      (*nodes) += 2;
+      return diff - 2 * Count(flips) - 1;
+   }
+   return diff;
+}
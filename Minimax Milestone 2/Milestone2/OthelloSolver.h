@@ -0,0 +1,38 @@
+#ifndef OTHELLOSOLVER_H
+#define OTHELLOSOLVER_H
+
+#include "EndgameSolver.h"
+#include "OthelloBits.h"
+
+// Exact solver for OthelloBoards with few empty squares left.  It copies the
+// board into a pair of bitboards (see OthelloBits), one for the pieces of 
+// the player to move and one for the opponent's, and runs a negamax search
+// on the final piece difference.  Moves are ordered fastest-first (fewest
+// opponent replies) while more than kShallow squares are empty; below that,
+// the search skips move generation entirely, trying empty squares in
+// quadrants with an odd number of empties first (parity), and the last
+// empty square gets its own routine.
+class OthelloSolver : public EndgameSolver, protected OthelloBits {
+public:
+   enum {kShallow = 6, kInf = 65};
+
+   OthelloSolver() : EndgameSolver("OthelloBoard") {}
+
+   int GetRemaining(const Board *brd) const;
+   long Solve(Board *brd, BestMove *res) const;
+
+protected:
+   enum {kMaxMoves = 64, kGameOver = -2, kPass = -1};
+
+   static int Negamax(Bits mine, Bits theirs, int alpha, int beta,
+    bool passed, int *bestSq, int *replySq, long *nodes);
+   static int SolveShallow(Bits mine, Bits theirs, int alpha, int beta,
+    bool passed, long *nodes);
+   static int SolveLast(Bits mine, Bits theirs, int sq, long *nodes);
+
+   static const Bits mQuadrants[4];
+
+   static OthelloSolver mSolver;
+};
+
+#endif
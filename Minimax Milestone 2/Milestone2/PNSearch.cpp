@@ -0,0 +1,287 @@
+#include <assert.h>
+#include <climits>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+#include "PNSearch.h"
+
+using namespace std;
+
+const long PNSearch::kInfinity = LONG_MAX / 4;
+
+PNSearch::PNSearch(long maxNodes, long tableSize) : mMaxNodes(maxNodes),
+ mTableSize(tableSize), mWinner(0), mAborted(false) {
+}
+
+PNSearch::~PNSearch() {
+   Table::iterator itr;
+
+   for (itr = mTable.begin(); itr != mTable.end(); itr++)
+      delete (*itr).first;
+}
+
+PNSearch::Result PNSearch::Solve(Board *brd, int winner, Board::Move **bestMove)
+{
+   const Board::Key *key;
+   list<Board::Move *> moves;
+   list<Board::Move *>::iterator mIter;
+   set<TCmpPtr<const Board::Key> > seen;
+   set<TCmpPtr<const Board::Key> >::iterator sIter;
+   clock_t start = clock();
+   long phi, delta, childPhi, childDelta;
+   Result rtn;
+
+   mWinner = winner;
+   mAborted = false;
+   mStats = Stats();
+
+   MID(brd, kInfinity, kInfinity);
+
+   key = brd->GetKey();
+   Lookup(key, &phi, &delta);
+   delete key;
+
+   rtn = phi == 0 ? kProven : delta == 0 ? kDisproven : kUnknown;
+   if (rtn != kUnknown && brd->GetWhoseMove() != mWinner)
+      rtn = rtn == kProven ? kDisproven : kProven;
+
+   // The winning move is any whose board is lost for the side then to move.
+   if (bestMove) {
+      *bestMove = NULL;
+      if (rtn == kProven && brd->GetWhoseMove() == mWinner) {
+         brd->GetAllMoves(&moves);
+         for (mIter = moves.begin(); mIter != moves.end(); mIter++) {
+            if (!*bestMove) {
+               brd->ApplyMove((*mIter)->Clone());
+               key = brd->GetKey();
+               Lookup(key, &childPhi, &childDelta);
+               delete key;
+               brd->UndoLastMove();
+               if (childDelta == 0) {
+                  *bestMove = *mIter;
+                  continue;
+               }
+            }
+            delete *mIter;
+         }
+      }
+   }
+
+   if (rtn != kUnknown) {
+      mStats.proofSize = CountProof(brd, &seen);
+      for (sIter = seen.begin(); sIter != seen.end(); sIter++)
+         delete *sIter;
+   }
+
+   mStats.tableEntries = mTable.size();
+   mStats.seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+   return rtn;
+}
+
+// Multiple iterative deepening: search below *brd until its phi reaches 
+// thPhi or its delta reaches thDelta, always descending into the child with
+// least delta (the one most easily shown lost for its side to move).  Each
+// child gets thresholds that return control here as soon as another child
+// becomes the better choice.
+void PNSearch::MID(Board *brd, long thPhi, long thDelta) {
+   const Board::Key *key = brd->GetKey();
+   list<Board::Move *> moves, childMoves;
+   list<Board::Move *>::iterator mIter, bestIter;
+   vector<const Board::Key *> keys;
+   vector<pair<long, long> > fixed;
+   long startNodes = mStats.nodes, phi, delta, childPhi, childDelta,
+    bestPhi = 0, secondDelta;
+   unsigned ndx, best;
+
+   mStats.nodes++;
+   brd->GetAllMoves(&moves);
+   if (moves.size() == 0) {
+      Settle(brd, &phi, &delta);
+      Store(key, phi, delta, 1);
+      return;
+   }
+
+   // Note each child's key, and fix the numbers of any child repeating a
+   // board on the current line.  A repeated board counts as not won for the
+   // winner, unless the game is over on it.  (Its key may match an earlier
+   // board's only because the key omits some detail, such as a pass count.)
+   mPath.push_back(key);
+   for (mIter = moves.begin(); mIter != moves.end(); mIter++) {
+      brd->ApplyMove((*mIter)->Clone());
+      keys.push_back(brd->GetKey());
+      fixed.push_back(pair<long, long>(-1, -1));
+      if (OnPath(keys.back())) {
+         brd->GetAllMoves(&childMoves);
+         if (childMoves.size() == 0)
+            Settle(brd, &fixed.back().first, &fixed.back().second);
+         else {
+            fixed.back().first = brd->GetWhoseMove() == mWinner ? kInfinity
+             : 0;
+            fixed.back().second = kInfinity - fixed.back().first;
+         }
+         for (; childMoves.size(); childMoves.pop_front())
+            delete childMoves.front();
+      }
+      brd->UndoLastMove();
+   }
+
+   while (true) {
+      phi = secondDelta = kInfinity;
+      delta = 0;
+      for (ndx = best = 0, mIter = moves.begin(); ndx < keys.size();
+       ndx++, mIter++) {
+         if (fixed[ndx].first >= 0) {
+            childPhi = fixed[ndx].first;
+            childDelta = fixed[ndx].second;
+         }
+         else
+            Lookup(keys[ndx], &childPhi, &childDelta);
+
+         delta = Add(delta, childPhi);
+         if (childDelta < phi) {
+            secondDelta = phi;
+            phi = childDelta;
+            bestPhi = childPhi;
+            best = ndx;
+            bestIter = mIter;
+         }
+         else if (childDelta < secondDelta)
+            secondDelta = childDelta;
+      }
+
+      if (phi >= thPhi || delta >= thDelta || mAborted)
+         break;
+      if (mStats.nodes >= mMaxNodes) {
+         mAborted = true;
+         break;
+      }
+
+      brd->ApplyMove((*bestIter)->Clone());
+      MID(brd, thDelta >= kInfinity ? kInfinity : thDelta - delta + bestPhi,
+       TMin(thPhi, Add(secondDelta, 1)));
+      brd->UndoLastMove();
+   }
+
+   mPath.pop_back();
+   Store(key, phi, delta, mStats.nodes - startNodes);
+
+   for (ndx = 0; ndx < keys.size(); ndx++)
+      delete keys[ndx];
+   for (mIter = moves.begin(); mIter != moves.end(); mIter++)
+      delete *mIter;
+}
+
+// Numbers for a board not yet in the table are 1 and 1.
+void PNSearch::Lookup(const Board::Key *key, long *phi, long *delta) const {
+   Table::const_iterator itr = mTable.find(key);
+
+   if (itr == mTable.end())
+      *phi = *delta = 1;
+   else {
+      *phi = (*itr).second.phi;
+      *delta = (*itr).second.delta;
+   }
+}
+
+// Record the numbers for 'key', taking ownership of it.
+void PNSearch::Store(const Board::Key *key, long phi, long delta, long work) {
+   Entry entry = {phi, delta, work};
+   pair<Table::iterator, bool> ins = mTable.insert(Table::value_type(key,
+    entry));
+
+   if (!ins.second) {
+      (*ins.first).second = entry;
+      delete key;
+   }
+   else if ((long)mTable.size() > mTableSize)
+      Collect();
+}
+
+// Set the numbers for *brd, on which the game is over.
+void PNSearch::Settle(const Board *brd, long *phi, long *delta) const {
+   long value = brd->GetValue();
+   bool won = mWinner == 0 ? value >= Board::kWinVal : value <= -Board::kWinVal;
+
+   // The side to move has achieved its aim iff it is the winner and won, or
+   // the other player and the winner didn't.
+   *phi = won == (brd->GetWhoseMove() == mWinner) ? 0 : kInfinity;
+   *delta = kInfinity - *phi;
+}
+
+bool PNSearch::OnPath(const Board::Key *key) const {
+   list<const Board::Key *>::const_iterator itr;
+
+   for (itr = mPath.begin(); itr != mPath.end(); itr++)
+      if (**itr == *key)
+         return true;
+   return false;
+}
+
+// Drop the half of the table that took least work to compute.  Boards 
+// whose outcome is settled are kept ahead of others that took equal work,
+// unless that would leave the table still mostly full.
+void PNSearch::Collect() {
+   vector<long> works;
+   Table::iterator itr, next;
+   long cutoff;
+   bool keepSettled;
+
+   for (itr = mTable.begin(); itr != mTable.end(); itr++)
+      works.push_back((*itr).second.work);
+   nth_element(works.begin(), works.begin() + works.size() / 2, works.end());
+   cutoff = works[works.size() / 2];
+
+   for (keepSettled = true; (long)mTable.size() > mTableSize * 3 / 4;
+    keepSettled = false) {
+      for (itr = mTable.begin(); itr != mTable.end(); itr = next) {
+         next = itr;
+         next++;
+         if ((*itr).second.work < cutoff || ((*itr).second.work == cutoff
+          && (!keepSettled || ((*itr).second.phi && (*itr).second.delta)))) {
+            delete (*itr).first;
+            mTable.erase(itr);
+         }
+      }
+      if (!keepSettled)
+         break;
+   }
+   mStats.collections++;
+}
+
+// Count the distinct boards of the proof (or disproof) below *brd.  Where
+// the side to move achieves its aim, one child showing so is enough; where 
+// it fails, every child is needed.  Boards dropped from the table count as
+// one apiece.
+long PNSearch::CountProof(Board *brd, set<TCmpPtr<const Board::Key> > *seen) {
+   const Board::Key *key = brd->GetKey();
+   list<Board::Move *> moves;
+   list<Board::Move *>::iterator mIter;
+   long phi, delta, childPhi, childDelta, count = 1;
+   bool done = false;
+
+   if (!seen->insert(key).second) {
+      delete key;
+      return 0;
+   }
+
+   Lookup(key, &phi, &delta);
+   if (phi != 0 && delta != 0)
+      return count;
+
+   brd->GetAllMoves(&moves);
+   for (mIter = moves.begin(); mIter != moves.end(); mIter++) {
+      brd->ApplyMove(*mIter);
+      if (!done) {
+         key = brd->GetKey();
+         Lookup(key, &childPhi, &childDelta);
+         delete key;
+         if (phi != 0 || childDelta == 0) {
+            count += CountProof(brd, seen);
+            done = phi == 0;
+         }
+      }
+      brd->UndoLastMove();
+   }
+
+   return count;
+}
@@ -0,0 +1,83 @@
+#ifndef PNSEARCH_H
+#define PNSEARCH_H
+
+#include <map>
+#include <list>
+#include <set>
+#include "Board.h"
+#include "MyLib.h"
+
+// Depth-first proof-number (df-pn) search, deciding whether one player can
+// force a win (a kWinVal outcome in that player's favor) from a board.  It
+// works through the generic Board interface alone, so serves every game,
+// and proves or disproves directly rather than searching to a fixed depth.
+//
+// Each node carries a proof number (how many more leaves must be shown won
+// to prove it) and a disproof number, kept in a transposition table of at
+// most 'tableSize' entries.  When the table fills, the entries that took
+// least work to compute are dropped.  A board repeating one earlier on the
+// current line is taken as not won, which is sound for proofs, though in
+// games with repetition a disproof may be too pessimistic.
+class PNSearch {
+public:
+   enum Result {kUnknown, kProven, kDisproven};
+
+   struct Stats {
+      long nodes;          // Boards expanded
+      long proofSize;      // Distinct boards in the proof or disproof tree
+      long tableEntries;   // Table entries at the end of the search
+      long collections;    // Times the table was pruned
+      double seconds;      // Time taken
+
+      Stats() : nodes(0), proofSize(0), tableEntries(0), collections(0),
+       seconds(0.0) {}
+   };
+
+   PNSearch(long maxNodes, long tableSize = kDefTableSize);
+   ~PNSearch();
+
+   // Decide whether 'winner' (numbered as by GetWhoseMove) can force a win
+   // from *brd, expanding at most maxNodes boards.  If proven and 'winner'
+   // is to move, *bestMove (if non-NULL) gets a winning move, owned by the
+   // caller.  *brd is left as it was.
+   Result Solve(Board *brd, int winner, Board::Move **bestMove = NULL);
+
+   const Stats &GetStats() const {return mStats;}
+
+protected:
+   enum {kDefTableSize = 1 << 20};
+
+   // kInfinity marks proven or disproven numbers; sums saturate at it.
+   static const long kInfinity;
+
+   // Proof and disproof numbers, relative to the player to move at the
+   // node: phi is the proof number if the winner is to move, and otherwise
+   // the disproof number, while delta is the other.
+   struct Entry {
+      long phi, delta;
+      long work;           // Nodes expanded below this board
+   };
+
+   typedef std::map<TCmpPtr<const Board::Key>, Entry> Table;
+
+   void MID(Board *brd, long thPhi, long thDelta);
+   void Lookup(const Board::Key *key, long *phi, long *delta) const;
+   void Store(const Board::Key *key, long phi, long delta, long work);
+   void Settle(const Board *brd, long *phi, long *delta) const;
+   bool OnPath(const Board::Key *key) const;
+   void Collect();
+   long CountProof(Board *brd, std::set<TCmpPtr<const Board::Key> > *seen);
+
+   static long Add(long v1, long v2)
+    {return v1 >= kInfinity - v2 ? kInfinity : v1 + v2;}
+
+   long mMaxNodes;
+   long mTableSize;
+   int mWinner;
+   bool mAborted;       // Node limit reached
+   Table mTable;
+   std::list<const Board::Key *> mPath;  // Keys of boards on current line
+   Stats mStats;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#include "PhaseTimer.h"
+
+#ifdef PHASE_TIMERS
+
+#include <chrono>
+#include "MyLib.h"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+thread_local PhaseTimer::Scope *PhaseTimer::mTop;
+
+static const char *const kNames[PhaseTimer::kNumPhases] = {
+   "Search", "MoveGen", "Apply", "Eval", "Key", "Table"
+};
+
+// Ticks and time at startup, from which Report finds seconds per tick.
+static const uint64_t gStartTicks = PhaseTimer::Now();
+static const Clock::time_point gStartTime = Clock::now();
+
+// Writes the report as the program ends, if anything was timed.
+static struct Reporter {
+   ~Reporter() {PhaseTimer::Report(cerr);}
+} gReporter;
+
+void PhaseTimer::Report(ostream &os) {
+   double secsPerTick = chrono::duration<double>(Clock::now() - gStartTime)
+    .count() / TMax(Now() - gStartTicks, (uint64_t)1);
+   uint64_t ticks[kNumPhases] = {0}, total = 0;
+   long calls[kNumPhases] = {0};
+   int phase;
+
+   Shards::ForEach([&](const Shard &shard) {
+      for (phase = 0; phase < kNumPhases; phase++) {
+         ticks[phase] += shard.ticks[phase].load(memory_order_relaxed);
+         calls[phase] += shard.calls[phase].load(memory_order_relaxed);
+      }
+   });
+   for (phase = 0; phase < kNumPhases; phase++)
+      total += ticks[phase];
+   if (!total)
+      return;
+
+   os << "Phase times, over all threads:" << endl;
+   for (phase = 0; phase < kNumPhases; phase++)
+      os << FString("   %-8s %12ld calls %10.3fs %5.1f%% %8.1fns/call",
+       kNames[phase], calls[phase], ticks[phase] * secsPerTick,
+       100.0 * ticks[phase] / total, calls[phase] ? ticks[phase]
+       * secsPerTick * 1e9 / calls[phase] : 0.0) << endl;
+}
+
+// Add an ended thread's times to these.
+void PhaseTimer::Shard::Add(const Shard &src) {
+   int phase;
+
+   for (phase = 0; phase < kNumPhases; phase++) {
+      ticks[phase] += src.ticks[phase].load(memory_order_relaxed);
+      calls[phase] += src.calls[phase].load(memory_order_relaxed);
+   }
+}
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef PHASETIMER_H
+#define PHASETIMER_H
+
+// Timers for the phases of a minimax search, compiled in only when
+// PHASE_TIMERS is defined (e.g. by adding -DPHASE_TIMERS to CPPFLAGS), and
+// otherwise compiled to nothing at all.
+//
+// PHASE_TIMER(kPhase) times the rest of the enclosing block as kPhase, and
+// PHASE_TIMED(kPhase, expr) times just the expression.  Timers nest, and
+// each phase is charged only its own time, not that of timers nested within
+// it, so the phases' times add up to the time spent under any timer.  Each
+// thread adds to counts of its own, and when the program ends the totals
+// over all threads are written to cerr.
+//
+// The timers are at the minimax search's own call sites, in
+// SimpleAIPlayer::Minimax and MinimaxEngine, not inside the Board and Move
+// primitives.  So the breakdown covers only minimax searches.  Work done
+// elsewhere, as by MCTSPlayer, PNSearch or a whole-board EndgameSolver
+// solve, is either untimed or charged to kSearch as a whole.
+#ifdef PHASE_TIMERS
+
+#include <atomic>
+#include <iostream>
+#include <stdint.h>
+#include "ThreadShards.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+class PhaseTimer {
+public:
+   enum Phase {
+      kSearch,       // Search logic not in any other phase
+      kMoveGen,      // GetAllMoves, GetCaptureMoves
+      kApply,        // ApplyMove, UndoLastMove
+      kEval,         // GetValue
+      kKey,          // GetKey
+      kTable,        // Transposition table lookups and stores
+      kNumPhases
+   };
+
+   // Times its own lifetime as one call of a phase.
+   class Scope {
+   public:
+      Scope(Phase phase) : mPhase(phase), mParent(mTop) {
+         uint64_t now = Now();
+
+         if (mParent)
+            Charge(mParent->mPhase, now - mParent->mStart, 0);
+         mStart = now;
+         mTop = this;
+      }
+
+      ~Scope() {
+         uint64_t now = Now();
+
+         Charge(mPhase, now - mStart, 1);
+         if (mParent)
+            mParent->mStart = now;
+         mTop = mParent;
+      }
+
+   private:
+      Scope(const Scope &);
+      void operator=(const Scope &);
+
+      Phase mPhase;
+      Scope *mParent;          // Scope this one interrupts, or NULL
+      uint64_t mStart;         // When this one last started or resumed
+   };
+
+   // Time in ticks: TSC cycles where there is a TSC, else nanoseconds.
+   static uint64_t Now() {
+#if defined(__x86_64__) || defined(__i386__)
+      return __rdtsc();
+#else
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+       std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+   }
+
+   // Write each phase's calls, seconds and share of the total, over all
+   // threads so far.
+   static void Report(std::ostream &os);
+
+protected:
+   // One thread's times, as for MemStats.
+   struct Shard {
+      std::atomic<uint64_t> ticks[kNumPhases];
+      std::atomic<long> calls[kNumPhases];
+
+      void Add(const Shard &src);
+   };
+   typedef ThreadShards<Shard> Shards;
+
+   static void Charge(Phase phase, uint64_t ticks, long calls) {
+      Shard &shard = Shards::Local();
+
+      shard.ticks[phase].store(shard.ticks[phase].load(
+       std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+      shard.calls[phase].store(shard.calls[phase].load(
+       std::memory_order_relaxed) + calls, std::memory_order_relaxed);
+   }
+
+   static thread_local Scope *mTop;      // Innermost running Scope
+};
+
+#define PHASE_TIMER(phase) PhaseTimer::Scope phaseTimer(PhaseTimer::phase)
+#define PHASE_TIMED(phase, expr) \
+ ([&]() -> decltype(auto) \
+ {PhaseTimer::Scope phaseTimer(PhaseTimer::phase); return expr;}())
+
+#else
+
+#define PHASE_TIMER(phase)
+#define PHASE_TIMED(phase, expr) (expr)
+
+#endif
+
+#endif
@@ -0,0 +1,105 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "Class.h"
+#include "Board.h"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+// Halfmoves after which a playout is cut off unfinished
+const int kMaxPlies = 1000;
+
+// Totals from one run of playouts, over all its threads.
+struct Tally {
+   atomic<long> playouts, wins, draws;     // wins are player 0's
+
+   Tally() : playouts(0), wins(0), draws(0) {}
+};
+
+// Play out from *brd until 'end', by the board's own kernel or, if
+// 'generic', by Board::Playout's moves and undos, adding to *tally.
+static void RunPlayouts(Board *brd, bool generic, unsigned seed,
+ Clock::time_point end, int maxPlies, Tally *tally) {
+   XorShift rng(seed);
+   long playouts = 0, wins = 0, draws = 0;
+   int result;
+
+   do {
+      result = generic ? brd->Board::Playout(&rng, maxPlies)
+       : brd->Playout(&rng, maxPlies);
+      playouts++;
+      wins += result > 0;
+      draws += result == 0;
+   } while ((playouts & 0x3F) || Clock::now() < end);
+
+   tally->playouts += playouts;
+   tally->wins += wins;
+   tally->draws += draws;
+}
+
+// Measure random playout speed from the starting board.  Usage:
+//
+// PlayoutBench BoardClass seconds maxThreads
+//
+// For 1 to maxThreads threads, each playing out on its own copy of the
+// board, report playouts per second in all and per thread, first for the
+// board's Playout and then for the generic Board::Playout.  The win and
+// draw rates should agree between the two, as a check on the former.
+int main(int argc, char **argv) {
+   const BoardClass *boardClass = argc > 1 ? dynamic_cast<const BoardClass *>(
+    BoardClass::ForName(argv[1])) : NULL;
+   double seconds = argc > 2 ? atof(argv[2]) : 0.0;
+   int maxThreads = argc > 3 ? atoi(argv[3]) : 0, threads, ndx, pass;
+   vector<Board *> boards;
+   vector<thread> workers;
+   Clock::time_point start, end;
+   double elapsed;
+   Board *brd;
+
+   if (argc != 4 || !boardClass || seconds <= 0.0 || maxThreads < 1) {
+      cout << "Usage: PlayoutBench BoardClass seconds maxThreads" << endl;
+      return -1;
+   }
+   brd = dynamic_cast<Board *>(boardClass->NewInstance());
+
+   cout << fixed;
+   for (pass = 0; pass < 2; pass++) {
+      cout << (pass ? "Generic Board::Playout" : "Board's own Playout") << endl;
+      for (threads = 1; threads <= maxThreads; threads++) {
+         Tally tally;
+
+         for (ndx = 0; ndx < threads; ndx++)
+            boards.push_back(brd->Clone());
+         start = Clock::now();
+         end = start + chrono::duration_cast<Clock::duration>(
+          chrono::duration<double>(seconds));
+         for (ndx = 0; ndx < threads; ndx++)
+            workers.push_back(thread(RunPlayouts, boards[ndx], pass == 1,
+             ndx + 1, end, kMaxPlies, &tally));
+         for (ndx = 0; ndx < threads; ndx++)
+            workers[ndx].join();
+         elapsed = chrono::duration<double>(Clock::now() - start).count();
+
+         cout << setw(3) << threads << " threads: " << setprecision(0)
+          << setw(10) << tally.playouts / elapsed << " playouts/s, "
+          << setw(10) << tally.playouts / elapsed / threads << " per thread"
+          << setprecision(3) << "  (wins " << (double)tally.wins
+          / tally.playouts << ", draws " << (double)tally.draws
+          / tally.playouts << ")" << endl;
+
+         for (ndx = 0; ndx < threads; ndx++)
+            delete boards[ndx];
+         boards.clear();
+         workers.clear();
+      }
+   }
+
+   delete brd;
+   return 0;
+}
@@ -0,0 +1,131 @@
+#include <assert.h>
+#include "Ponderer.h"
+#include "Class.h"
+#include "Book.h"
+
+using namespace std;
+
+Ponderer::Ponderer(SearchService *svc, const SearchService::Request &req)
+ : mService(svc), mReq(req), mOwnTable(NULL), mPonderKey(NULL),
+ mPonderCancel(NULL) {}
+
+Ponderer::~Ponderer() {
+   Stop();
+   delete mOwnTable;
+}
+
+BestMove Ponderer::Think(const Board *brd, const CancelToken *stop) {
+   SearchService::Request req;
+   Clock::time_point start = Clock::now(), end = start
+    + chrono::duration_cast<Clock::duration>(
+    chrono::duration<double>(mReq.seconds));
+   BestMove rtn;
+
+   // Copy the request only once it names the table, so that even the first
+   // search fills the table that pondering will use.
+   UseTable(brd);
+   req = mReq;
+   if (stop)
+      req.cancel = stop;
+   if (!IsPondering(brd)) {
+      Stop();
+      return mService->Submit(brd, req).get();
+   }
+
+   // A hit.  Give the search what remains of the time limit, if any.
+   while (mPonderResult.wait_for(chrono::milliseconds(kPollMs))
+    != future_status::ready)
+      if ((mReq.seconds > 0.0 && Clock::now() >= end)
+       || (req.cancel && req.cancel->IsCancelled()))
+         mPonderCancel->Cancel();
+   rtn = mPonderResult.get();
+
+   delete mPonderCancel;
+   mPonderCancel = NULL;
+   delete mPonderKey;
+   mPonderKey = NULL;
+
+   // A search cancelled before it found any move is no answer.
+   if (!rtn.HasMove()) {
+      mStats.misses++;
+      mStats.ponderBoards += rtn.numBoards;
+      return mService->Submit(brd, req).get();
+   }
+
+   mStats.hits++;
+   mStats.hitSeconds +=
+    chrono::duration<double>(start - mPonderStart).count();
+   return rtn;
+}
+
+void Ponderer::SetRequest(const SearchService::Request &req) {
+   mReq = req;
+   if (!mReq.table)
+      mReq.table = mOwnTable;
+}
+
+void Ponderer::Ponder(const Board *brd, const BestMove &best) {
+   SearchService::Request req;
+   Board *next;
+
+   Stop();
+   if (!best.HasMove() || !best.HasReply())
+      return;
+
+   next = brd->Clone();
+   next->ApplyMove(next->DecodeMove(best.move));
+   next->ApplyMove(next->DecodeMove(best.replyMove));
+   UseTable(next);
+   req = mReq;
+
+   // Ponder until told otherwise, to the depth limit.
+   mPonderCancel = new CancelToken(mReq.cancel);
+   req.cancel = mPonderCancel;
+   req.seconds = 0.0;
+   req.progress = nullptr;
+   req.stats = NULL;
+   req.opts.trace = NULL;
+
+   mPonderKey = next->GetKey();
+   mPonderStart = Clock::now();
+   mPonderResult = mService->Submit(next, req);
+   delete next;
+}
+
+void Ponderer::Stop() {
+   if (!mPonderCancel)
+      return;
+
+   mPonderCancel->Cancel();
+   mStats.misses++;
+   mStats.ponderBoards += mPonderResult.get().numBoards;
+
+   delete mPonderCancel;
+   mPonderCancel = NULL;
+   delete mPonderKey;
+   mPonderKey = NULL;
+}
+
+bool Ponderer::IsPondering(const Board *brd) const {
+   const Board::Key *key;
+   bool rtn;
+
+   if (!mPonderCancel)
+      return false;
+
+   key = brd->GetKey();
+   rtn = key && mPonderKey && *key == *mPonderKey;
+   delete key;
+   return rtn;
+}
+
+// Share one table among all searches, if the boards' class uses one.
+void Ponderer::UseTable(const Board *brd) {
+   const BoardClass *cls;
+
+   if (mReq.table)
+      return;
+   cls = dynamic_cast<const BoardClass *>(brd->GetClass());
+   if (cls && cls->UseTransposition())
+      mReq.table = mOwnTable = new Book();
+}
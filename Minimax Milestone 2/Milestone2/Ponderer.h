@@ -0,0 +1,74 @@
+#ifndef PONDERER_H
+#define PONDERER_H
+
+#include <future>
+#include "SearchService.h"
+
+// Ponderer chooses moves through a SearchService, and uses the opponent's
+// thinking time too.  Once it has chosen a move, Ponder starts a background
+// search of the board expected after that move and its predicted reply.  If
+// the opponent does play that reply, the next Think is a ponder hit, and
+// takes over the search already under way.  Otherwise it is a miss: the
+// ponder search is stopped, and a new one started.  Either way the searches
+// share one transposition table, so the work of a missed ponder search still
+// serves any board it reached.
+class Ponderer {
+public:
+   struct Stats {
+      long hits;            // Thinks answered by a ponder search
+      long misses;          // Ponder searches of boards never reached
+      long ponderBoards;    // Boards examined by missed ponder searches
+      double hitSeconds;    // Ponder time taken over by hits
+
+      Stats() : hits(0), misses(0), ponderBoards(0), hitSeconds(0.0) {}
+   };
+
+   // Search with *svc, as 'req' directs.  If req.table is NULL, the
+   // Ponderer keeps its own table, when the boards' class uses one.
+   Ponderer(SearchService *svc, const SearchService::Request &req);
+
+   // Stop any ponder search, and wait for it.
+   ~Ponderer();
+
+   // Choose a move for *brd, as svc->Submit(brd, req) would.  On a ponder
+   // hit, a search already done returns at once; one still running is
+   // left to finish within req.seconds of this call, and req.stats is left
+   // as it was.  If 'stop' is given, cancelling it ends this search early,
+   // in place of req.cancel.
+   BestMove Think(const Board *brd, const CancelToken *stop = NULL);
+
+   // Use 'req' for later searches, keeping the table.  A ponder search
+   // already running keeps the limits it started with.
+   void SetRequest(const SearchService::Request &req);
+
+   // Start pondering the board reached from *brd by best.move and then
+   // best.replyMove, if both are known.  Any earlier ponder search is
+   // stopped first, and counted a miss.
+   void Ponder(const Board *brd, const BestMove &best);
+
+   // Stop pondering, counting the search a miss.
+   void Stop();
+
+   const Stats &GetStats() const {return mStats;}
+
+protected:
+   typedef std::chrono::steady_clock Clock;
+
+   enum {kPollMs = 5};    // How often Think checks 'stop' on a hit
+
+   bool IsPondering(const Board *brd) const;
+   void UseTable(const Board *brd);
+
+   SearchService *mService;
+   SearchService::Request mReq;
+   Book *mOwnTable;                  // Table made here, if any
+
+   const Board::Key *mPonderKey;     // Board being pondered, or NULL
+   CancelToken *mPonderCancel;
+   std::future<BestMove> mPonderResult;
+   Clock::time_point mPonderStart;
+
+   Stats mStats;
+};
+
+#endif
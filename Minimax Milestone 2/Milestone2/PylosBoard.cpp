@@ -7,131 +7,98 @@
 #include "PylosMove.h"
 #include "PylosView.h"
 #include "BasicKey.h"
+#include "MinimaxEngine.h"
 
 using namespace std;
 
-// Static initialization stuff
-PylosBoard::Set PylosBoard::mSets[kNumSets];
-PylosBoard::Cell PylosBoard::mCells[kNumCells];
-int PylosBoard::mOffs[PylosBoard::kDim] = {0, 16, 25, 29};
-PylosBoard::Rules PylosBoard::mRules;
-
-BoardClass PylosBoard::mClass =  BoardClass("PylosBoard", &CreatePylosBoard,
- "Pylos", &PylosView::mClass, &PylosDlg::mClass, PylosBoard::SetOptions,
- PylosBoard::GetOptions, true);
-
-// The C++ definition here isn't required in C++11, which I'm using.
-// Put it there anyways to force the "static block" to run.
-PylosBoard::PylosBoardInitializer PylosBoard::mInitializer;
-
-PylosBoard::PylosBoard() : mWhite(0), mBlack(0), mWhoseMove(kWhite),
- mWhiteReserve(kStones), mBlackReserve(kStones), mLevelLead(0), mFreeLead(0) {
-   // Initialize mSpots
-   ClearMSpots();
-}
-
-void PylosBoard::ClearMSpots() {
-   for (int row = 0; row < kDim; row++) {
-      for (int col = 0; col < kDim; col++) {
-         mSpots[row][col].empty = GetCell(row, col, 0);
-         mSpots[row][col].top = NULL;
-      }
-   }
-}
-
-void PylosBoard::StaticInit() {
-   Cell *cell = NULL;
+// Build the cell and alignment tables.  Run by the compiler, once, for
+// mTables.
+constexpr PylosBoard::Tables PylosBoard::MakeTables() {
+   Tables tbl = {};
    int level = 0, row = 0, col = 0, index = 0, nextCell = 0, setCounter = 0;
-   
-   // Initialize mCells
+   int below[kSqr] = {};
+
+   // Cells, with their supporting and supported cells
    for (level = 0; level < kDim; level++) {
       for (row = 0; row < kDim - level; row++) {
          for (col = 0; col < kDim - level; col++, nextCell++) {
-            
-            cell = mCells + nextCell;
-            cell->level = level;
-            cell->mask = 1 << nextCell;
+            Cell &cell = tbl.cells[nextCell];
 
-            // [Staley] Set up below and above pointers.
+            cell.level = level;
+            cell.mask = 1U << nextCell;
+            cell.below = cell.above = kNoCell;
             if (level > 0) {
-               // Tie adjacent above/below pointers
-               cell->below[kNW] = GetCell(row, col, level - 1);
-               cell->below[kNE] = GetCell(row, col + 1, level - 1);
-               cell->below[kSE] = GetCell(row + 1, col + 1, level - 1);
-               cell->below[kSW] = GetCell(row + 1, col, level - 1);
-               cell->below[kNW]->above = cell;
-               
-               // Special case: Topmost cell doesn't have an above/below pointer
-               if (level == (kDim - 1))
-                  cell->above = NULL;
-               
+               below[kNW] = GetCell(row, col, level - 1);
+               below[kNE] = GetCell(row, col + 1, level - 1);
+               below[kSE] = GetCell(row + 1, col + 1, level - 1);
+               below[kSW] = GetCell(row + 1, col, level - 1);
+
+               // The NW cell below is in the same spot.
+               cell.below = below[kNW];
+               tbl.cells[below[kNW]].above = nextCell;
+
                for (index = 0; index < kSqr; index++) {
-                  cell->below[index]->sups |= cell->mask;
-                  cell->subs |= cell->below[index]->mask; 
+                  tbl.cells[below[index]].sups |= cell.mask;
+                  cell.subs |= 1U << below[index];
                }
             }
          }
       }
    }
-   
-   // Set up square alignments
-   for (level = 0; level < kDim; level++) {
-      for (row = 0; row < kDim - level; row++) {
-         for (col = 0; col < kDim - level; col++, nextCell++) {
-            if (level < kDim - 1 && row < kDim - level -1
-             && col < kDim - level - 1) { 
 
-               // Nil out the bitmask before you set it.
-               mSets[setCounter] = 0;
+   // Square alignments
+   for (level = 0; level < kDim - 1; level++)
+      for (row = 0; row < kDim - level - 1; row++)
+         for (col = 0; col < kDim - level - 1; col++)
+            tbl.sets[setCounter++] = 1U << GetCell(row, col, level)
+             | 1U << GetCell(row, col + 1, level)
+             | 1U << GetCell(row + 1, col, level)
+             | 1U << GetCell(row + 1, col + 1, level);
 
-               // Set up square alignments
-               mSets[setCounter] |= GetCell(row, col, level)->mask;
-               mSets[setCounter] |= GetCell(row, col + 1, level)->mask;
-               mSets[setCounter] |= GetCell(row + 1, col, level)->mask;
-               mSets[setCounter++] |= GetCell(row +1 , col + 1, level)->mask;
-            }
-         }
-      }
-   }
-   
-   // Set up horizontal/vertical alignments
+   // Horizontal, then vertical, alignments
    for (level = 0; level < kDim - 2; level++) {
-      // Horizontal alignments
-      for (row = 0; row < kDim - level; row++, setCounter++) {
-         // Nil out the bitmask before you set it.
-         mSets[setCounter] = 0;
-
-         // OR in the horizontal alignment
+      for (row = 0; row < kDim - level; row++, setCounter++)
          for (col = 0; col < kDim - level; col++)
-            mSets[setCounter] |= GetCell(row, col, level)->mask;
-      }
+            tbl.sets[setCounter] |= 1U << GetCell(row, col, level);
 
-      // Vertical alignments
-      for (col = 0; col < kDim - level; col++, setCounter++) {
-         
-         // Nil out the bitmask before you set it.
-         mSets[setCounter] = 0;
-
-         // OR in the vertical alignment
+      for (col = 0; col < kDim - level; col++, setCounter++)
          for (row = 0; row < kDim - level; row++)
-            mSets[setCounter] |= GetCell(row, col, level)->mask;
-      }
+            tbl.sets[setCounter] |= 1U << GetCell(row, col, level);
    }
-   
+
    // [Staley] Copy set data back into cell set collections.
-   // For each cell, check all of the alignments to see if
-   // the cell belongs to that alignment.
-   for(nextCell = 0; nextCell < kNumCells; nextCell++) {
-      for (setCounter = 0; setCounter < kNumSets; setCounter++) {
-         if((mCells[nextCell].mask & mSets[setCounter])) {
-            index = mCells[nextCell].setCount;
-
-            // Nil out the existing bitmask, then OR in what you have.
-            mCells[nextCell].sets[index] = 0;
-            mCells[nextCell].sets[index] |= mSets[setCounter];
-
-            mCells[nextCell].setCount++;
-         }
+   for (nextCell = 0; nextCell < kNumCells; nextCell++)
+      for (setCounter = 0; setCounter < kNumSets; setCounter++)
+         if (tbl.cells[nextCell].mask & tbl.sets[setCounter])
+            tbl.cellSets[nextCell][tbl.cells[nextCell].setCount++]
+             = tbl.sets[setCounter];
+
+   return tbl;
+}
+
+// Static initialization stuff
+const PylosBoard::Tables PylosBoard::mTables = MakeTables();
+constexpr int PylosBoard::mOffs[PylosBoard::kDim];
+PylosBoard::Rules PylosBoard::mDefaultRules;
+
+BoardClass PylosBoard::mClass =  BoardClass("PylosBoard", &CreatePylosBoard,
+ "Pylos", &PylosView::mClass, &PylosDlg::mClass, PylosBoard::SetOptions,
+ PylosBoard::GetOptions, true);
+
+MinimaxT<PylosBoard> PylosBoard::mMinimax("PylosBoard");
+
+PylosBoard::PylosBoard() : mWhite(0), mBlack(0), mWhoseMove(kWhite),
+ mWhiteReserve(kStones), mBlackReserve(kStones), mLevelLead(0), mFreeLead(0),
+ mRules(mDefaultRules) {
+   // Initialize mSpots
+   ClearMSpots();
+}
+
+void PylosBoard::ClearMSpots() {
+   for (int row = 0; row < kDim; row++) {
+      for (int col = 0; col < kDim; col++) {
+         mSpots[row][col].empty = GetCell(row, col, 0);
+         mSpots[row][col].top = kNoCell;
       }
    }
 }
@@ -179,31 +146,26 @@ void PylosBoard::UpdateBoardValuation() {
    // Go through all pieces and update mLevelLead and mFreeLead
    Set allPieces(mWhite|mBlack);
    mLevelLead = mFreeLead = 0;
-   for (int level = 0; level < kDim; level++) {
-      for (int row = 0; row < kDim - level; row++) {
-         for (int col = 0; col < kDim - level; col++) {
-
-            Cell *cell = GetCell(row, col, level);
-            // Update mLevelLead
-            if (cell->mask & mWhite) {
-               mLevelLead += level;
-            } else if (cell->mask & mBlack)  {
-               mLevelLead -= level;
-            }
+   for (const Cell *cell = mTables.cells; cell < mTables.cells + kNumCells;
+    cell++) {
+      // Update mLevelLead
+      if (cell->mask & mWhite) {
+         mLevelLead += cell->level;
+      } else if (cell->mask & mBlack)  {
+         mLevelLead -= cell->level;
+      }
 
-            // Update mFreeLead
-            if ((cell->sups & allPieces) == 0 && (cell->mask & mWhite)) {
-               mFreeLead += 1;
-            } else if ((cell->sups & allPieces) == 0 && (cell->mask & mBlack)) {
-               mFreeLead -= 1;
-            }
-         }
+      // Update mFreeLead
+      if ((cell->sups & allPieces) == 0 && (cell->mask & mWhite)) {
+         mFreeLead += 1;
+      } else if ((cell->sups & allPieces) == 0 && (cell->mask & mBlack)) {
+         mFreeLead -= 1;
       }
    }
 }
 
 void PylosBoard::ApplyMove(Move *move) {
-   PylosMove *tm = dynamic_cast<PylosMove *>(move);
+   PylosMove *tm = static_cast<PylosMove *>(move);
 
    int rChange = -1;  // [Staley] Start by assuming we'll lose one from reserve
    PylosMove::LocVector::iterator locIter = tm->mLocs.begin();
@@ -234,7 +196,7 @@ void PylosBoard::UndoLastMove() {
    // [Staley] Fill in
    // [Ian] Basically, do ApplyMove() backwards (obviously)
 
-   PylosMove *moveToUndo = dynamic_cast<PylosMove *>(mMoveHist.back());
+   PylosMove *moveToUndo = static_cast<PylosMove *>(mMoveHist.back());
 
    // Start by assuming that the reserve will gain a new piece.
    int rChange = 1;
@@ -274,7 +236,7 @@ void PylosBoard::UndoLastMove() {
 
 void PylosBoard::GetAllMoves(list<Move *> *uncastMoves) const {
    int tRow, tCol, sRow, sCol;
-   Cell *trg, *src;
+   const Cell *trg, *src;
    PylosMove::LocVector locs;
    list<PylosMove *>::iterator itr;
    list<PylosMove *> *moves = reinterpret_cast<list<PylosMove *>*>(uncastMoves);
@@ -289,16 +251,20 @@ void PylosBoard::GetAllMoves(list<Move *> *uncastMoves) const {
 
    for (tRow = 0; tRow < kDim; tRow++)
       for (tCol = 0; tCol < kDim; tCol++) {
-         trg = mSpots[tRow][tCol].empty;
-         if (trg && (trg->subs & (mWhite|mBlack)) == trg->subs) { 
+         if (mSpots[tRow][tCol].empty == kNoCell)
+            continue;
+         trg = mTables.cells + mSpots[tRow][tCol].empty;
+         if ((trg->subs & (mWhite|mBlack)) == trg->subs) { 
             locs.clear();
             locs.push_back(pair<int, int>(tRow, tCol));
             moves->push_back(new PylosMove(locs, PylosMove::kReserve));
 
             for (sRow = 0; sRow < kDim; sRow++)
                for (sCol = 0; sCol < kDim; sCol++) {
-                  src = mSpots[sRow][sCol].top;
-                  if (src && (src->sups & (mWhite|mBlack)) == 0
+                  if (mSpots[sRow][sCol].top == kNoCell)
+                     continue;
+                  src = mTables.cells + mSpots[sRow][sCol].top;
+                  if ((src->sups & (mWhite|mBlack)) == 0
                    && (src->mask & sideMask) && src->level < trg->level
                    && (sRow < tRow || sRow > tRow + 1    
                    || sCol < tCol || sCol > tCol + 1)) {
@@ -314,6 +280,25 @@ void PylosBoard::GetAllMoves(list<Move *> *uncastMoves) const {
 
 }
 
+// Takebacks are the captures: moves that return marbles to the reserve after
+// completing an alignment.  They are never compulsory.
+bool PylosBoard::GetCaptureMoves(list<Move *> *moves) const {
+   list<Move *>::iterator itr;
+   PylosMove *move;
+
+   GetAllMoves(moves);
+   for (itr = moves->begin(); itr != moves->end(); ) {
+      move = dynamic_cast<PylosMove *>(*itr);
+      if (move->mLocs.size() > (move->mType == PylosMove::kPromote ? 2 : 1))
+         itr++;
+      else {
+         delete move;
+         itr = moves->erase(itr);
+      }
+   }
+   return false;
+}
+
 // [Staley] For each move in *moves that completes one or more sets, add all
 // [Staley] combination of spots to take back.
 void PylosBoard::AddTakeBacks(list<PylosMove *> *moves) const {
@@ -335,11 +320,11 @@ void PylosBoard::AddTakeBacks(list<PylosMove *> *moves) const {
       PylosMove *move = *movesCopyIter;
       Spot *moveSpot = &mSpots[move->mLocs[0].first][move->mLocs[0].second];
       Spot *promoteFromSpot = NULL;
-      Cell *moveCell = moveSpot->empty;
+      int moveCell = moveSpot->empty;
 
       // Sanity check:  A possible move shouldn't be able to be applied to a 
       // filled Spot.
-      assert(moveCell != NULL);
+      assert(moveCell != kNoCell);
 
       // Straightaway, put down the marble to inspect the new state of the 
       // board (to check for possible alignments).  Also, don't forget to 
@@ -374,7 +359,7 @@ void PylosBoard::AddTakeBacks(list<PylosMove *> *moves) const {
 
 void PylosBoard::CalculateAllTakebacks(list<PylosMove *> *allMoves,
  list<PylosMove *>::iterator moveIter, Set *mSet,
- PylosMove *move, Cell *moveCell) const {
+ PylosMove *move, int moveCell) const {
 
    // TODO: These sets can probably be lists instead, and insert at O(1)
    // instead of O(logn).
@@ -383,11 +368,13 @@ void PylosBoard::CalculateAllTakebacks(list<PylosMove *> *allMoves,
    bool alignmentFound = false;
 
    // For each of this cell's possible alignments,
-   for (int i = 0; i < kSetsPerCell && !alignmentFound; i++) {
+   const uint *sets = mTables.cellSets[moveCell];
+
+   for (int i = 0; i < mTables.cells[moveCell].setCount && !alignmentFound;
+    i++) {
       // If putting down this cell creates a new alignment 
       // (checking against all possible alignments),
-      if (moveCell->sets[i] &&
-       (moveCell->sets[i] & *mSet) == moveCell->sets[i]) {
+      if ((sets[i] & *mSet) == sets[i]) {
 
          // Then you've ID'd a move that "completes one or more sets."
          // From this point you should just go through and compile a list
@@ -403,7 +390,7 @@ void PylosBoard::CalculateAllTakebacks(list<PylosMove *> *allMoves,
             // Grab the Spot that corresponds to the free marble that we're 
             // about to yank 
             Spot *freeMarble1 = &mSpots[(*fmIter1).first][(*fmIter1).second];
-            assert(freeMarble1->top != NULL);
+            assert(freeMarble1->top != kNoCell);
 
             // Construct the "takeback move" using the data from the 
             // potentialMove and the location of freeMarble1
@@ -497,14 +484,118 @@ void PylosBoard::FindFreeMarbles(std::set<std::pair<short,short> > *freeMarbles,
 // Also, the freeMarble to take back must belong to that player.
 void PylosBoard::InsertIfFree(std::set<std::pair<short,short> > *freeMarbles,
    Set *playerMarbles, int row, int col) const {
-      Cell *marble = mSpots[row][col].top;
+      const Cell *marble;
 
-      if (marble && (marble->mask & *playerMarbles)
+      if (mSpots[row][col].top == kNoCell)
+         return;
+      marble = mTables.cells + mSpots[row][col].top;
+      if ((marble->mask & *playerMarbles)
             && (marble->sups & (mWhite|mBlack)) == 0) {
       freeMarbles->insert(std::pair<short,short>(row,col));
    }
 }
 
+// Play out on copies of mWhite, mBlack and the reserves.  The placement (or
+// promotion) is chosen uniformly from those GetAllMoves allows, and then, if
+// it completes an alignment, the takeback uniformly from those it allows.
+// A game cut off unfinished goes to whoever has more marbles in reserve.
+int PylosBoard::Playout(XorShift *rng, int maxPlies) {
+   struct {char trg, src;} moves[kNumCells * kStones];
+   Set white = mWhite, black = mBlack, *mine, all, taken, fromMask;
+   int whiteRes = mWhiteReserve, blackRes = mBlackReserve, side = mWhoseMove;
+   int plies, numMoves, trg, src, set, *reserve;
+   const Cell *cell, *cells = mTables.cells;
+
+   for (plies = 0; plies < maxPlies && whiteRes && blackRes; plies++) {
+      mine = side == kWhite ? &white : &black;
+      reserve = side == kWhite ? &whiteRes : &blackRes;
+      all = white | black;
+
+      numMoves = 0;
+      for (trg = 0; trg < kNumCells; trg++) {
+         cell = cells + trg;
+         if ((cell->mask & all) || (cell->subs & all) != cell->subs)
+            continue;
+         moves[numMoves].trg = trg;
+         moves[numMoves++].src = -1;
+         for (src = 0; src < kNumCells; src++)
+            if ((cells[src].mask & *mine & ~cell->subs) 
+             && cells[src].level < cell->level
+             && (cells[src].sups & all) == 0) {
+               moves[numMoves].trg = trg;
+               moves[numMoves++].src = src;
+            }
+      }
+      if (numMoves == 0)
+         break;
+
+      numMoves = rng->Below(numMoves);
+      cell = cells + moves[numMoves].trg;
+      fromMask = moves[numMoves].src < 0 ? 0 
+       : cells[moves[numMoves].src].mask;
+      *mine = (*mine | cell->mask) & ~fromMask;
+      if (!fromMask)
+         (*reserve)--;
+
+      for (set = 0; set < cell->setCount; set++)
+         if ((mTables.cellSets[cell - cells][set] & *mine)
+          == mTables.cellSets[cell - cells][set]) {
+            taken = PickTakeBacks(rng, *mine, white | black);
+            *mine &= ~taken;
+            for (; taken; taken &= taken - 1)
+               (*reserve)++;
+            break;
+         }
+      side = -side;
+   }
+
+   if (whiteRes == 0 || blackRes == 0)
+      return whiteRes == 0 ? -1 : 1;
+   return whiteRes > blackRes ? 1 : whiteRes < blackRes ? -1 : 0;
+}
+
+PylosBoard::Set PylosBoard::GetFree(Set mine, Set all) {
+   Set free = 0;
+   int cell;
+
+   for (cell = 0; cell < kNumCells; cell++)
+      if ((mTables.cells[cell].mask & mine)
+       && (mTables.cells[cell].sups & all) == 0)
+         free |= mTables.cells[cell].mask;
+   return free;
+}
+
+// The choices are no takeback, any one free marble, or any free marble and
+// then another free once the first is gone.  Each pair is counted once: a
+// second marble free from the start must come later in mTables.cells than
+// the first.
+PylosBoard::Set PylosBoard::PickTakeBacks(XorShift *rng, Set mine, Set all) {
+   Set free = GetFree(mine, all), bits, one, rest, two;
+   int pass, count = 1, pick = -1;
+
+   // Count the choices, then find the one picked.
+   for (pass = 0; pass < 2; pass++) {
+      if (pick-- == 0)
+         return 0;
+      for (bits = free; bits; bits &= bits - 1) {
+         one = bits & -bits;
+         if (pick-- == 0)
+            return one;
+         count++;
+         for (rest = GetFree(mine & ~one, all & ~one); rest; rest &= rest - 1) {
+            two = rest & -rest;
+            if (!(two & free) || two > one) {
+               if (pick-- == 0)
+                  return one | two;
+               count++;
+            }
+         }
+      }
+      pick = rng->Below(count);
+   }
+   return 0;
+}
+
 Board::Move *PylosBoard::CreateMove() const {
    return new PylosMove(PylosMove::LocVector(1), PylosMove::kReserve);
 }
@@ -552,20 +643,20 @@ void PylosBoard::Delete() {
 
    // DON'T reset the static rules to their defaults, since this is a member
    // function, and Delete() gets called on the cmpBoard in the BoardTest.
-//    PylosBoard::mRules.marbleWgt = 100;
-//    PylosBoard::mRules.levelWgt = 20;
-//    PylosBoard::mRules.freeWgt = 6;
+//    PylosBoard::mDefaultRules.marbleWgt = 100;
+//    PylosBoard::mDefaultRules.levelWgt = 20;
+//    PylosBoard::mDefaultRules.freeWgt = 6;
 }
 
+// The player to move and the two Sets of kNumCells bits: 61 bits in all, in
+// one long.  (The reserves follow from the Sets.)
 Board::Key *PylosBoard::GetKey() const {
-   BasicKey<2> *rtn = new BasicKey<2>();
+   ulong vals[1];
    
-   // Don't forget to nil out existing bitmasks before you play with them.
-   rtn->vals[0] = rtn->vals[1] = 0;
-   rtn->vals[0] = (mWhoseMove == kWhite) << kNumCells | mWhite;
-   rtn->vals[1] = mBlack;
+   vals[0] = ((ulong)(mWhoseMove == kWhite) << kNumCells | mWhite)
+    << kNumCells | mBlack;
    
-   return rtn;
+   return new BasicKey<1>(vals);
 }
 
 istream &PylosBoard::Read(istream &is) {
@@ -580,17 +671,22 @@ istream &PylosBoard::Read(istream &is) {
    Delete();
 
    // Read in the Rules that the board should use.
-   is.read((char *)&PylosBoard::mRules, sizeof(Rules));
+   is.read((char *)&mRules, sizeof(Rules));
    mRules.EndSwap();
 
+   // A short file leaves the stream failed, and the board with the moves
+   // read whole before that point.
    is.read((char *)&moveCount, sizeof(moveCount));
-   assert(moveCount != -1);  // sanity check to ensure the read() happened
-   for (int i = 0; i < moveCount; i++) {
+   for (int i = 0; is && i < moveCount; i++) {
       // Will this mLocs on the RTS still be there, since it's being
       // inserted as a member variable of something on the RTH?
       // Well, mLocs *should* be copy-constructed in.
       PylosMove *newMove = new PylosMove(PylosMove::LocVector(),0);
       is >> *newMove;
+      if (!is) {
+         delete newMove;
+         break;
+      }
 
       ApplyMove(newMove);
    }
@@ -630,7 +726,7 @@ ostream &PylosBoard::Write(ostream &os) const {
 // [Staley] SetOptions methods by implementing the setOptions command, using 
 // [Staley] the PylosDlg object.
 void *PylosBoard::GetOptions() {
-   return new Rules(mRules);
+   return new Rules(mDefaultRules);
 }
 
 // [Staley] Write the two methods GetOptions and SetOptions of PylosBoard, 
@@ -648,7 +744,15 @@ void *PylosBoard::GetOptions() {
 // [Staley] SetOptions methods by implementing the setOptions command, using 
 // [Staley] the PylosDlg object.
 void PylosBoard::SetOptions(const void *opts) {
-   mRules = *reinterpret_cast<const Rules *>(opts);
+   mDefaultRules = *reinterpret_cast<const Rules *>(opts);
+}
+
+void *PylosBoard::GetRules() const {
+   return new Rules(mRules);
+}
+
+void PylosBoard::SetRules(const void *rules) {
+   mRules = *reinterpret_cast<const Rules *>(rules);
 }
 
 void PylosBoard::Rules::SetMarble(int val) {
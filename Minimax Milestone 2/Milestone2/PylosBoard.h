@@ -11,8 +11,9 @@
 // Cannot #include "PylosBoard.h" as per the spec.
 
 class PylosMove;
+template <class B> class MinimaxT;
 
-class PylosBoard : public Board {
+class PylosBoard final : public Board {
 public:   
    const static int kDim = 4;
    const static int kLevelWeight = 20;
@@ -26,8 +27,8 @@ public:
       int marbleWgt; // Weight of each marble in reserve
       int freeWgt;   // Weight for each uncovered marble
       
-      Rules() : levelWgt(kLevelWeight), freeWgt(kFreeWeight),
-       marbleWgt(kMarbleWeight) {}
+      Rules() : levelWgt(kLevelWeight), marbleWgt(kMarbleWeight),
+       freeWgt(kFreeWeight) {}
       
       int GetLevel()  {return levelWgt;}
       int GetMarble() {return marbleWgt;}
@@ -47,6 +48,8 @@ public:
    void ApplyMove(Move *);
    void UndoLastMove();
    void GetAllMoves(std::list<Move *> *) const;
+   bool GetCaptureMoves(std::list<Move *> *) const;
+   int Playout(XorShift *rng, int maxPlies);
    Move *CreateMove() const;
    int GetWhoseMove() const {return mWhoseMove == kBlack;}
    
@@ -55,6 +58,8 @@ public:
 
    Board *Clone() const;
    Key *GetKey() const;
+   void *GetRules() const;
+   void SetRules(const void *rules);
 
    // [Staley] May add a public method for use by PylosView.
    // Public helper function that returns true if a cell is occupied
@@ -63,9 +68,9 @@ public:
    // "byWhom" expects either kWhite or kBlack.
    bool CellOccupied(int row, int col, int level, int byWhom) const {
       if (byWhom == kWhite)
-         return GetCell(row, col, level)->mask & this->mWhite;
+         return mTables.cells[GetCell(row, col, level)].mask & this->mWhite;
       else if (byWhom == kBlack) 
-         return GetCell(row, col, level)->mask & this->mBlack;
+         return mTables.cells[GetCell(row, col, level)].mask & this->mBlack;
    }
    
    // [Staley] Add a static method to support the Class system, plus a static
@@ -74,39 +79,48 @@ public:
    // [Staley] Option accessor/mutator.  GetOptions returns dynamically allocated
    // [Staley] object representing options. SetOptions takes similar object.  Caller
    // [Staley] owns object in both cases.
+   // These are the default Rules copied by each newly created board.
    static void *GetOptions();
    static void SetOptions(const void *opts);
 
-   // [Staley] Arrange for this to be called at static initialization time, to set up
-   // [Staley] the static mCells and mSets.  See below
-   static void StaticInit();
-   
    const Class *GetClass() const { return &mClass; };
       
 protected:
    enum {kBitsPerCell = 2, kCellMask = 0x3, kBlack = -1, kWhite = 1};
    enum {kNumCells = 30, kSetsPerCell = 6, kNumSets = 28, kStones = 15};
    enum {kNW = 0, kNE = 1, kSE = 2, kSW = 3, kSqr = 4};
+   enum {kNoCell = -1};
             
    typedef ulong Set;
    
+   // One cell, as indices into mTables.cells and masks of its 30 bits, in 16
+   // bytes so that the whole table spans under eight cache lines.
    struct Cell {
-      int level;     // [Staley] Level the cell is on, numbering from 0 (bottom)
-      Set mask;    // [Staley] Mask with this cell's bit turned on
-      Set subs;    // [Staley] Mask having 1-bits for the cells supporting this one
-      Set sups;    // [Staley] Mask having 1-bits for the cells supported by this one
-      int setCount;  // [Staley] Number of alignments this cell might be part of
-      Set sets[kSetsPerCell];  // [Staley] Masks for the cells in each alignment
-      Cell *below[kSqr];       // [Staley] Direct pointers to the 4 supporting cells
-      Cell *above;             // [Staley] Direct pointer to the supported cell
-      
-      Cell() : level(0), mask(0), subs(0), sups(0), setCount(0),
-       above(0) {
-         memset((void *)sets, 0, sizeof(sets));
-         memset((void *)below, 0, sizeof(below));
-      }
-      
-      void addSet(Set set) {sets[setCount++] = set;}
+      uint mask;     // [Staley] Mask with this cell's bit turned on
+      uint subs;     // [Staley] Mask having 1-bits for the cells supporting this one
+      uint sups;     // [Staley] Mask having 1-bits for the cells supported by this one
+      char level;    // [Staley] Level the cell is on, numbering from 0 (bottom)
+      char below;    // Supporting cell in the same spot, or kNoCell
+      char above;    // Supported cell in the same spot, or kNoCell
+      char setCount; // [Staley] Number of alignments this cell might be part of
+   };
+
+   // All the static cell and alignment data, built at compile time by
+   // MakeTables.
+   struct Tables {
+      Cell cells[kNumCells];  // [Staley] One Cell for each cell
+
+      // [Staley] Array of Sets holding bitmaps for each alignment.  The first
+      // [Staley] 14 alignments are the squares, in level-major, row-submajor
+      // [Staley] order.  Next 8 are the horizontal followed by the vertical
+      // [Staley] level-0 rows, and the last 6 are the horizontal followed by
+      // [Staley] the vertical level 1 rows.
+      uint sets[kNumSets];
+
+      // Masks for the cells of each alignment a cell is part of, the first
+      // cells[n].setCount of them valid.  Apart from cells, as they're only
+      // needed for the cell just filled.
+      uint cellSets[kNumCells][kSetsPerCell];
    };
    
    // [Staley] Describes the situation at one row/col "spot", which is a column of
@@ -116,10 +130,10 @@ protected:
    // [Staley] layers.  A Spot has a top filled cell (possibly null if no cells are 
    // [Staley] filled) and possibly an empty cell above that if there's still room.
    struct Spot {
-      Cell *empty;    // [Staley] Next empty cell, or null
-      Cell *top;      // [Staley] Top filled cell, or null
+      char empty;    // [Staley] Next empty cell, or kNoCell
+      char top;      // [Staley] Top filled cell, or kNoCell
       
-      Spot(): empty(0), top(0) {}
+      Spot(): empty(kNoCell), top(kNoCell) {}
    };
    
    std::istream &Read(std::istream &);
@@ -136,36 +150,46 @@ protected:
    // [Staley] Free all PylosBoard storage
    void Delete();
 
+   // Return the cells of 'mine' that support no marble of 'all'.
+   static Set GetFree(Set mine, Set all);
+
+   // Choose at random how many of 'mine' to take back, and which, after a
+   // move completing an alignment.  Return the cells taken.
+   static Set PickTakeBacks(XorShift *rng, Set mine, Set all);
+
    // [Staley] Is row, col in bounds assuming we are on level "lvl"?
    static inline bool InBounds(int row, int col, int lvl = 0) {
       return InRange<int>(0, row, kDim - lvl) && InRange<int>(0, col, kDim - lvl);
    }
 
-   // [Staley] Return the Cell, within mCells, corresponding to row, col, lvl.  Note 
-   // [Staley] that row sizes on "lvl" are (kDim-lvl)
-   static inline Cell *GetCell(int row, int col, int lvl) {
-      return mCells + mOffs[lvl] + (kDim - lvl)*row + col;
+   // [Staley] Return the index of the Cell, within mTables.cells, corresponding to 
+   // [Staley] row, col, lvl.  Note that row sizes on "lvl" are (kDim-lvl)
+   static constexpr int GetCell(int row, int col, int lvl) {
+      return mOffs[lvl] + (kDim - lvl)*row + col;
    }
    
    // [Staley] Return a bitmask with a 1-bit for (row, col, lvl), or 0 if out of bounds.
    static inline Set GetMask(int row, int col, int lvl) {
-      return InBounds(row, col, lvl) ? GetCell(row, col, lvl)->mask : 0;
+      return InBounds(row, col, lvl) ? 1UL << GetCell(row, col, lvl) : 0;
    }
+
+   // Build mTables.
+   static constexpr Tables MakeTables();
    
    // [Staley] Adjust "spot" to reflect putting a marble on its top, and adjust the mWhite
    // [Staley] and mBlack masks, but do not update state relative to board valuation.  
    // [Staley] Used to "test out" a marble placement at low cost.
    inline void HalfPut(Spot *spot) const {
       // Ensure that you're not trying to HalfPut() a completely filled Spot
-      assert(spot != NULL && spot->empty != NULL);
+      assert(spot != NULL && spot->empty != kNoCell);
 
       spot->top = spot->empty;
-      spot->empty = spot->top->above;
+      spot->empty = mTables.cells[spot->top].above;
       
       if (mWhoseMove == kWhite)
-         mWhite |= spot->top->mask;
+         mWhite |= mTables.cells[spot->top].mask;
       else if (mWhoseMove == kBlack)
-         mBlack |= spot->top->mask;
+         mBlack |= mTables.cells[spot->top].mask;
       
       // WARNING: Here write a verifier that all the spots are correct.  That is,
       // do the "IAmSane()" function for Spot correction in the board's state.
@@ -174,44 +198,30 @@ protected:
    // [Staley] Like HalfPut, but in reverse
    inline void HalfTake(Spot *spot) const {
       // Ensure that you're not trying to HalfTake() an empty Spot
-      assert(spot != NULL && spot->top != NULL);
+      assert(spot != NULL && spot->top != kNoCell);
 
       // Clear out the spot->top bit.
       if (mWhoseMove == kWhite)
-         mWhite &= ~(spot->top->mask);
+         mWhite &= ~(Set)mTables.cells[spot->top].mask;
       else if (mWhoseMove == kBlack)
-         mBlack &= ~(spot->top->mask);
+         mBlack &= ~(Set)mTables.cells[spot->top].mask;
       
       // [Staley] Fill in
       // Reset the spot so that it reflects the removed piece.
       
       spot->empty = spot->top;
-      spot->top = spot->top->below[kNW];
+      spot->top = mTables.cells[spot->top].below;
    }
 
-   // [Staley] Add possible nested class and member datum to force StaticInit call.
-   struct PylosBoardInitializer {
-      PylosBoardInitializer() {
-         PylosBoard::StaticInit();
-      }
-   };
-   static PylosBoardInitializer mInitializer;
-   
-   // [Staley] Rules object for PylosBoard
-   static Rules mRules;
-   
-   // [Staley] Array of Sets holding bitmaps for each alignment.  The first 14 
-   // [Staley] alignments are the squares, in level-major, row-submajor order
-   // [Staley] Next 8 are the horizontal followed by the vertical level-0 rows,
-   // [Staley] and the last 6 are the horizontal followed by the vertical level 
-   // [Staley] 1 rows.
-   static Set  mSets[kNumSets];
+   // Default Rules object for new PylosBoards
+   static Rules mDefaultRules;
    
-   // [Staley] One Cell object for each cell, in 
-   static Cell mCells[kNumCells];
+   // Cell and alignment data.  Constant-initialized, so it is ready before
+   // any code runs.
+   static const Tables mTables;
 
-   // [Staley] Offsets within mCells at which each level starts
-   static int mOffs[kDim];
+   // [Staley] Offsets within mTables.cells at which each level starts
+   static constexpr int mOffs[kDim] = {0, 16, 25, 29};
    
    // [Staley] Array of Spots, one for each row/col combination
    mutable Spot mSpots[kDim][kDim];
@@ -228,6 +238,7 @@ protected:
    int mBlackReserve; // [Staley] How many marbles has black in his 
    int mLevelLead;    // [Staley] Amount by which white leads in terms of marble level
    int mFreeLead;     // [Staley] Amount of promoteable marbles white has over black.
+   Rules mRules;      // Weights this board's GetValue uses
 
    // [Staley] History of moves leading to this point.
    std::list<Move *> mMoveHist;
@@ -237,7 +248,7 @@ private:
    // My own helper function for AddTakebacks().
    void CalculateAllTakebacks(std::list<PylosMove *> *moves, 
     std::list<PylosMove *>::iterator moveIter,
-    Set *mSet, PylosMove *potentialMove, Cell *potentialMoveCell) const;
+    Set *mSet, PylosMove *potentialMove, int potentialMoveCell) const;
 
    void FindFreeMarbles(std::set<std::pair<short,short> > *freeMarbles, 
    Set *playerMarbles, unsigned short startRow = 0, unsigned short startCol = 0) const;
@@ -249,6 +260,7 @@ private:
    void UpdateBoardValuation();
 
    static BoardClass mClass;
+   static MinimaxT<PylosBoard> mMinimax;  // Search compiled for this class
    static Object *CreatePylosBoard() { return new PylosBoard; }
 
 };
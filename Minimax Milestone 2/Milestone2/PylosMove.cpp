@@ -1,34 +1,34 @@
 #include "MyLib.h"
+#include "Arena.h"
+#include "SlabPool.h"
 #include "PylosMove.h"
 #include "PylosBoard.h"
 #include <assert.h>
 
 using namespace std;
 
-vector<PylosMove *> PylosMove::mFreeList;
 static const int kPlayOne = 3, kPlayTwo = 7, kPlayThree = 11;
 static const int kPromTwo = 5, kPromThree = 9, kPromFour = 13;
 
 void *PylosMove::operator new(size_t sz) {
    // [Staley] Return next node from freelist, or allocate one
-	void *temp;
+   // (from the current search's Arena, if there is one, or else the pool).
+	void *temp = Arena::AllocCurrent(sz);
 
-	if (mFreeList.size()) {
-	  temp = mFreeList.back();
-	  mFreeList.pop_back();
-	} else {
-	  temp = ::new char[sz];
-	}
+	if (!temp)
+	   temp = SlabPool<PylosMove>::Alloc();
 
-   mOutstanding++;
+   MemStats::Alloc(MemStats::kMove, sizeof(PylosMove));
 	return temp;
 }
 
 void PylosMove::operator delete(void *p) {
    // [Staley] release node pointed to by p to the freelist
-	mFreeList.push_back((PylosMove *)p);
+   // (or to the current Arena, if it came from there).
+	if (!Arena::FreeCurrent(p, sizeof(PylosMove)))
+	   SlabPool<PylosMove>::Free(p);
 
-   mOutstanding--;
+   MemStats::Free(MemStats::kMove, sizeof(PylosMove));
 }
 
 bool PylosMove::operator==(const Board::Move &rhs) const {
@@ -212,6 +212,35 @@ void PylosMove::operator=(const string &src) {
    AssertMe();
 }
 
+uint PylosMove::GetCode() const {
+   uint code = mType | mLocs.size() << 1, shift = 1 + kCountBits;
+   LocVector::const_iterator itr;
+
+   for (itr = mLocs.begin(); itr != mLocs.end(); itr++) {
+      code |= itr->first << shift | itr->second << (shift + kCoordBits);
+      shift += 2 * kCoordBits;
+   }
+   return code;
+}
+
+void PylosMove::SetCode(uint code) {
+   uint size = code >> 1 & ((1 << kCountBits) - 1), ndx;
+   uint shift = 1 + kCountBits, mask = (1 << kCoordBits) - 1;
+   LocVector locs(size);
+
+   if (size < (code & 1 ? 2 : 1) || size > (code & 1 ? 4 : 3)
+    || code >> (shift + 2 * kCoordBits * size))
+      throw BaseException(FString("Bad Pylos move code: %X", code));
+
+   for (ndx = 0; ndx < size; ndx++, shift += 2 * kCoordBits) {
+      locs[ndx].first = code >> shift & mask;
+      locs[ndx].second = code >> (shift + kCoordBits) & mask;
+   }
+
+   mType = code & 1;
+   mLocs = locs;
+}
+
 Board::Move *PylosMove::Clone() const {
    // [Staley] Make this just one line long, a single relatively short 
 	// [Staley] "return" statement.
@@ -245,7 +274,10 @@ istream &PylosMove::Read(istream &is) {
 
    is.read((char *)&mType, sizeof(mType));
    is.read((char *)&mLocsSize, sizeof(mLocsSize));
-   assert(mLocsSize != -1);  // sanity check to ensure mLocsSize was read().
+   if (!is || mLocsSize < 0) {
+      is.setstate(ios::failbit);
+      return is;
+   }
    mLocs.resize(mLocsSize);
    for (int i = 0; i < mLocsSize; i++) {
       
@@ -19,7 +19,7 @@
 // be added if a recovery pattern is completed as a result of 
 // the move.
 
-class PylosMove : public Board::Move {
+class PylosMove final : public Board::Move {
 public:
    enum {kReserve, kPromote};  // Enum to mark what type of move we are.
    typedef std::vector<std::pair<short, short> > LocVector;
@@ -33,11 +33,21 @@ public:
    bool operator<(const Board::Move &rhs) const;
    operator std::string() const;
    void operator=(const std::string &src);
+   uint GetCode() const;
+   void SetCode(uint code);
    Board::Move *Clone() const;
 
+   void operator delete(void *p);
+   void *operator new(size_t sz);
+
    // Mutual friendship between PylosBoard and PylosMove is allowed.
    friend class PylosBoard;
 protected:
+   // A code holds the move type in its low bit, the number of locations in
+   // the next kCountBits, and then each location's row and column in
+   // kCoordBits apiece.
+   enum {kCountBits = 3, kCoordBits = 2};
+
    std::istream &Read(std::istream &is);
    std::ostream &Write(std::ostream &) const;
 
@@ -47,14 +57,12 @@ protected:
 
    // Vector containing the locations that this move involves.
    LocVector mLocs;
-   
-   void operator delete(void *p);
-   void *operator new(size_t sz);
 
-    // [Staley] Static member datum to record freelist.  Use STL!
-	static std::vector<PylosMove *> mFreeList;
    void AssertMe();
 };
 
-#endif
+template <> struct GameTraits<PylosBoard> {
+   typedef PylosMove Move;
+};
 
+#endif
@@ -0,0 +1,177 @@
+#include <assert.h>
+#include "SearchService.h"
+#include "Class.h"
+#include "Book.h"
+#include "MyLib.h"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+// A queued or running search.  'stop' follows the caller's token, and is
+// cancelled directly on shutdown.
+struct SearchService::Job {
+   Board *board;
+   Request req;
+   CancelToken stop;
+   promise<BestMove> result;
+
+   Job(Board *brd, const Request &rq) : board(brd), req(rq), stop(rq.cancel) {}
+   ~Job() {delete board;}
+};
+
+SearchService::SearchService(int numWorkers) : mStopping(false) {
+   int ndx;
+
+   for (ndx = 0; ndx < TMax(numWorkers, 1); ndx++)
+      mWorkers.push_back(thread(&SearchService::Work, this));
+}
+
+SearchService::~SearchService() {
+   list<Job *>::iterator jIter;
+   int ndx;
+
+   {
+      lock_guard<mutex> lock(mLock);
+
+      mStopping = true;
+      for (jIter = mActive.begin(); jIter != mActive.end(); jIter++)
+         (*jIter)->stop.Cancel();
+   }
+   mReady.notify_all();
+
+   for (ndx = 0; ndx < (int)mWorkers.size(); ndx++)
+      mWorkers[ndx].join();
+}
+
+future<BestMove> SearchService::Submit(const Board *brd, const Request &req) {
+   Job *job = new Job(brd->Clone(), req);
+   future<BestMove> rtn = job->result.get_future();
+
+   assert(req.maxDepth >= 1);
+   {
+      lock_guard<mutex> lock(mLock);
+
+      if (mStopping)
+         job->stop.Cancel();
+      mQueue.push_back(job);
+      mActive.push_back(job);
+   }
+   mReady.notify_one();
+
+   return rtn;
+}
+
+// Run queued jobs until shutdown.  Jobs still queued at shutdown are run
+// too, already cancelled, so that every future gets its result.
+void SearchService::Work() {
+   Job *job;
+
+   for (;;) {
+      {
+         unique_lock<mutex> lock(mLock);
+
+         mReady.wait(lock, [this] {return mStopping || mQueue.size();});
+         if (mQueue.empty())
+            return;
+         job = mQueue.front();
+         mQueue.pop_front();
+      }
+
+      try {
+         job->result.set_value(Run(job));
+      }
+      catch (...) {
+         job->result.set_exception(current_exception());
+      }
+
+      {
+         lock_guard<mutex> lock(mLock);
+         mActive.remove(job);
+      }
+      delete job;
+   }
+}
+
+// Search within an Arena of the job's own, so that its Moves, Keys and
+// (unless the request shares one) table come and go without touching the
+// heap.  Only the result, copied out to the heap, outlives the Arena.
+BestMove SearchService::Run(Job *job) {
+   Arena arena;
+   BestMove rtn;
+   {
+      Arena::Scope scope(&arena);
+      BestMove best = Deepen(job, &arena);
+      Arena::Scope heap(NULL);
+
+      rtn = best;
+   }
+   return rtn;
+}
+
+// Deepen one level at a time, seeding each level's move ordering with the
+// last level's principal variation, until the depth limit, the end of the
+// game, or cancellation.  A level cut short is discarded, unless no level
+// has finished.
+BestMove SearchService::Deepen(Job *job, Arena *arena) {
+   const Request &req = job->req;
+   const BoardClass *cls = 
+    dynamic_cast<const BoardClass *>(job->board->GetClass());
+   CancelToken stop(&job->stop, req.seconds);
+   SimpleAIPlayer::Options opts = req.opts;
+   Book *table = req.table, *ownTable = NULL;
+   Clock::time_point start = Clock::now();
+   BestMove best, res;
+   PVLine pv;
+   SearchStats stats, level;
+   Progress progress;
+   long numBoards = 0;
+   int depth;
+   bool finished;
+
+   if (!table && cls && cls->UseTransposition())
+      table = ownTable = new Book(arena);
+   opts.cancel = &stop;
+   opts.stats = &level;
+
+   for (depth = 1; depth <= req.maxDepth && !stop.IsCancelled(); depth++) {
+      level.Clear();
+      finished = SimpleAIPlayer::Minimax(job->board, depth,
+       -Board::kWinVal - 1, Board::kWinVal + 1, &res, table, &pv, opts);
+      numBoards += res.numBoards;
+
+      // Counts total over all levels, but the branching factor is the
+      // last whole level's.
+      stats += level;
+      if (finished)
+         stats.SetLevel(level);
+
+      // Judge by the search itself, not the token, since a level that
+      // finished just as time ran out is still whole.
+      if (!finished) {
+         if (depth == 1)
+            best = res;
+         break;
+      }
+
+      best = res;
+      best.depth = depth;
+      if (req.progress) {
+         progress.depth = depth;
+         progress.best = &best;
+         progress.numBoards = numBoards;
+         progress.stats = &stats;
+         progress.seconds = 
+          chrono::duration<double>(Clock::now() - start).count();
+         req.progress(progress);
+      }
+      if (!best.HasMove())
+         break;                       // Game over
+   }
+
+   best.numBoards = numBoards;
+   if (req.stats)
+      *req.stats = stats;
+   delete ownTable;
+   return best;
+}
@@ -0,0 +1,97 @@
+#ifndef SEARCHSERVICE_H
+#define SEARCHSERVICE_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Arena.h"
+#include "BestMove.h"
+#include "SearchStats.h"
+#include "CancelToken.h"
+#include "SimpleAIPlayer.h"
+
+class Book;
+
+// Runs SimpleAIPlayer searches in the background on a fixed pool of worker
+// threads.  Submit queues a search and returns at once with a future for
+// its BestMove.  Each search deepens iteratively, one level at a time, so
+// that it has a complete result from the last finished level whenever it is
+// stopped, whether by the caller's CancelToken, its time limit or its depth
+// limit.  After each level it reports its progress to an optional callback.
+class SearchService {
+public:
+   // Progress of a search, as of the last level it finished.
+   struct Progress {
+      int depth;              // Level just finished
+      const BestMove *best;   // Its result (valid only during the callback)
+      long numBoards;         // Boards examined at all levels so far
+      double seconds;         // Time since the search started
+      const SearchStats *stats;  // Counts for all levels so far
+   };
+
+   // Called on the worker thread running the search, so it must be safe to
+   // call from there, and should return quickly.
+   typedef std::function<void(const Progress &)> ProgressFn;
+
+   struct Request {
+      int maxDepth;           // Deepest level to search
+      double seconds;         // Time limit, or 0 for none
+
+      // Stops the search early, if non-NULL.  The token must outlast the
+      // search.
+      const CancelToken *cancel;
+
+      // Transposition table to search with, or NULL to use a fresh one if
+      // the board's class uses transposition.  A table may serve many
+      // searches in turn, but never two at once.
+      Book *table;
+
+      ProgressFn progress;
+
+      // If non-NULL, set to the counts for all levels searched, once the
+      // search is done.  It must outlast the search.
+      SearchStats *stats;
+
+      // opts.cancel and opts.stats are set by the service
+      SimpleAIPlayer::Options opts;
+
+      Request(int dpt = 1) : maxDepth(dpt), seconds(0.0), cancel(NULL),
+       table(NULL), stats(NULL) {}
+   };
+
+   // Start 'numWorkers' worker threads (at least one).
+   SearchService(int numWorkers = 1);
+
+   // Cancel all searches, queued or running, and wait for the workers.
+   ~SearchService();
+
+   // Queue a search of a copy of *brd, taken before Submit returns.  The
+   // future's BestMove is from the deepest level finished, with depth set
+   // to that level and numBoards counting all levels.  If the search was 
+   // stopped before finishing even level 1, it is the best root move found
+   // so far, if any.
+   std::future<BestMove> Submit(const Board *brd, const Request &req);
+
+   int GetNumWorkers() const {return mWorkers.size();}
+
+protected:
+   struct Job;
+
+   void Work();
+   static BestMove Run(Job *job);
+   static BestMove Deepen(Job *job, Arena *arena);
+
+   std::vector<std::thread> mWorkers;
+   std::deque<Job *> mQueue;          // Jobs not yet started
+   std::list<Job *> mActive;          // Jobs queued or running
+   std::mutex mLock;                  // Guards all but mWorkers
+   std::condition_variable mReady;    // Signals a job queued, or shutdown
+   bool mStopping;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#include <math.h>
+#include "SearchStats.h"
+#include "MyLib.h"
+
+using namespace std;
+
+void SearchStats::Clear() {
+   int ply;
+
+   for (ply = 0; ply <= kMaxPly; ply++)
+      nodes[ply] = levelNodes[ply] = 0;
+   leafEvals = ttProbes = ttHits = ttStores = ttReplaceChecks = 0;
+   cutoffs = firstCutoffs = 0;
+}
+
+const SearchStats &SearchStats::operator+=(const SearchStats &src) {
+   int ply;
+
+   for (ply = 0; ply <= kMaxPly; ply++) {
+      nodes[ply] += src.nodes[ply];
+      levelNodes[ply] += src.levelNodes[ply];
+   }
+   leafEvals += src.leafEvals;
+   ttProbes += src.ttProbes;
+   ttHits += src.ttHits;
+   ttStores += src.ttStores;
+   ttReplaceChecks += src.ttReplaceChecks;
+   cutoffs += src.cutoffs;
+   firstCutoffs += src.firstCutoffs;
+   return *this;
+}
+
+void SearchStats::SetLevel(const SearchStats &level) {
+   int ply;
+
+   for (ply = 0; ply <= kMaxPly; ply++)
+      levelNodes[ply] = level.nodes[ply];
+}
+
+long SearchStats::GetNodes() const {
+   long rtn = 0;
+   int ply;
+
+   for (ply = 0; ply <= kMaxPly; ply++)
+      rtn += nodes[ply];
+   return rtn;
+}
+
+int SearchStats::GetMaxPly() const {
+   int ply;
+
+   for (ply = kMaxPly; ply > 0 && !nodes[ply]; ply--)
+      ;
+   return ply;
+}
+
+double SearchStats::GetFirstCutoffRate() const {
+   return cutoffs ? (double)firstCutoffs / cutoffs : 0.0;
+}
+
+double SearchStats::GetBranching() const {
+   const long *counts = levelNodes[0] ? levelNodes : nodes;
+   int ply, widest = 0;
+
+   for (ply = 1; ply <= kMaxPly; ply++)
+      if (counts[ply] > counts[widest])
+         widest = ply;
+
+   return widest && counts[0] ?
+    pow((double)counts[widest] / counts[0], 1.0 / widest) : 0.0;
+}
+
+void SearchStats::Write(ostream &os) const {
+   int ply, maxPly = GetMaxPly();
+
+   os << FString("nodes %ld leaves %ld ttprobes %ld tthits %ld ttstores %ld "
+    "ttreplacechecks %ld cutoffs %ld firstcutoffs %.3f ebf %.2f plynodes",
+    GetNodes(), leafEvals, ttProbes, ttHits, ttStores, ttReplaceChecks,
+    cutoffs, GetFirstCutoffRate(), GetBranching());
+   for (ply = 0; ply <= maxPly; ply++)
+      os << ' ' << nodes[ply];
+}
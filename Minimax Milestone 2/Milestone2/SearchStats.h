@@ -0,0 +1,55 @@
+#ifndef SEARCHSTATS_H
+#define SEARCHSTATS_H
+
+#include <iostream>
+#include "BestMove.h"
+
+// What a minimax search did, for measuring move ordering and pruning.
+// SimpleAIPlayer::Minimax adds a search's counts to the SearchStats named
+// in its Options, so one SearchStats may total many searches.
+struct SearchStats {
+   enum {kMaxPly = PVLine::kMaxPly};
+
+   long nodes[kMaxPly + 1];   // Boards reached at each ply from the root
+   long leafEvals;            // Boards valued by GetValue, in quiescence too
+   long ttProbes;             // Transposition table lookups
+   long ttHits;               // Lookups that found an entry deep enough
+   long ttStores;             // Entries added, or replaced by deeper ones
+   long ttReplaceChecks;      // Stores that found the board already there,
+                              // whether or not they replaced its entry
+   long cutoffs;              // Nodes whose window closed before all moves
+   long firstCutoffs;         // Cutoffs on the first move tried
+
+   // Boards at each ply of just the last whole level of an iterative
+   // deepening search (see SearchService), or all 0 if none was recorded.
+   // Summing levels of different depths would skew GetBranching.
+   long levelNodes[kMaxPly + 1];
+
+   SearchStats() {Clear();}
+
+   void Clear();
+   const SearchStats &operator+=(const SearchStats &src);
+
+   void CountNode(int ply) {nodes[ply < kMaxPly ? ply : kMaxPly]++;}
+
+   // Record 'level''s nodes as the last whole level's.
+   void SetLevel(const SearchStats &level);
+
+   long GetNodes() const;
+
+   // Return the deepest ply reached, the fraction of cutoffs made on the
+   // first move, and the effective branching factor: the per-ply growth
+   // from the root to the ply with the most nodes, which is the horizon
+   // unless quiescence thins out below it.  The branching factor is taken
+   // from levelNodes if any were recorded, and otherwise from nodes.  Each
+   // is 0 with nothing to measure.
+   int GetMaxPly() const;
+   double GetFirstCutoffRate() const;
+   double GetBranching() const;
+
+   // Write the counts on one line, as "name value" pairs, ending with the
+   // node count for each ply reached.
+   void Write(std::ostream &os) const;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include <string.h>
+#include "SearchTrace.h"
+#include "MyLib.h"
+
+using namespace std;
+
+const char SearchTrace::kMagic[8] = {'M', 'M', 'T', 'R', 'A', 'C', 'E', '1'};
+
+// Append 'val' to *buf in file byte order, and the reverse.
+template <class T>
+static void Put(vector<char> *buf, T val) {
+   val = EndianXfer(val);
+   buf->insert(buf->end(), (char *)&val, (char *)&val + sizeof(val));
+}
+
+template <class T>
+static void Get(const char **bytes, T *val) {
+   memcpy(val, *bytes, sizeof(*val));
+   *val = EndianXfer(*val);
+   *bytes += sizeof(*val);
+}
+
+SearchTrace::SearchTrace(const string &fileName)
+ : mOut(fileName.c_str(), ios::binary), mStarted(false) {
+   mBuf.reserve(kBufSize + kEntrySize);
+}
+
+SearchTrace::~SearchTrace() {
+   Flush();
+}
+
+// The header waits for the first search, which names the board class.
+void SearchTrace::BeginSearch(const Board *brd, int level) {
+   string name = brd->GetClass()->GetName();
+   Entry entry = {0, -1, (uint)level, 0, 0, 0, 0};
+
+   if (!mStarted) {
+      mBuf.insert(mBuf.end(), kMagic, kMagic + sizeof(kMagic));
+      Put(&mBuf, (int)name.size());
+      mBuf.insert(mBuf.end(), name.begin(), name.end());
+      mStarted = true;
+   }
+   Write(entry);
+}
+
+void SearchTrace::Record(int ply, int level, const Board::Move *mv, long min,
+ long max, long value, long numBoards) {
+   Entry entry = {ply, level, mv->GetCode(), min, max, value, numBoards};
+
+   Write(entry);
+}
+
+void SearchTrace::Flush() {
+   if (mBuf.size()) {
+      mOut.write(&mBuf[0], mBuf.size());
+      mOut.flush();
+      mBuf.clear();
+   }
+}
+
+void SearchTrace::Write(const Entry &entry) {
+   mBuf.push_back((char)entry.ply);
+   mBuf.push_back((char)entry.level);
+   Put(&mBuf, entry.move);
+   Put(&mBuf, entry.min);
+   Put(&mBuf, entry.max);
+   Put(&mBuf, entry.value);
+   Put(&mBuf, entry.numBoards);
+   if (mBuf.size() >= kBufSize)
+      Flush();
+}
+
+bool SearchTrace::Read(istream &is, Entry *entry) {
+   char bytes[kEntrySize];
+   const char *cursor = bytes + 2;
+
+   if (!is.read(bytes, kEntrySize))
+      return false;
+   entry->ply = (signed char)bytes[0];
+   entry->level = (signed char)bytes[1];
+   Get(&cursor, &entry->move);
+   Get(&cursor, &entry->min);
+   Get(&cursor, &entry->max);
+   Get(&cursor, &entry->value);
+   Get(&cursor, &entry->numBoards);
+   return true;
+}
+
+string SearchTrace::ReadHeader(istream &is) {
+   char magic[sizeof(kMagic)];
+   const char *cursor = magic;
+   int length;
+   string rtn;
+
+   if (!is.read(magic, sizeof(magic))
+    || memcmp(magic, kMagic, sizeof(kMagic)) != 0
+    || !is.read(magic, sizeof(length)))
+      return "";
+   Get(&cursor, &length);
+   if (length <= 0 || length > 256)
+      return "";
+   rtn.resize(length);
+   return is.read(&rtn[0], length) ? rtn : "";
+}
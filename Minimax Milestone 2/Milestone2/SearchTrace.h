@@ -0,0 +1,65 @@
+#ifndef SEARCHTRACE_H
+#define SEARCHTRACE_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Board.h"
+
+// A binary record of a minimax search, one Entry per move searched, for
+// diagnosing a search without the cost of dbg's line of text per node.
+// Entries are packed into a buffer and written a block at a time.  The file
+// starts with kMagic and the searched boards' class name, and a BeginSearch
+// entry (level < 0) marks the start of each search, so one file may hold
+// many.  TraceTool reads, filters and renders the files.
+//
+// A SearchTrace serves one search at a time.  All values are written in
+// the byte order Book files use (see EndianXfer).
+class SearchTrace {
+public:
+   struct Entry {
+      int ply;          // Halfmoves from the root to the node searched
+      int level;        // Its minimax level, or -1 for the start of a search
+      uint move;        // Code of the move (see Move::GetCode), or the level
+                        // of the search that begins
+      long min, max;    // The node's window after the move
+      long value;       // The value the move netted
+      long numBoards;   // Boards examined below the move
+   };
+
+   enum {kEntrySize = 2 + sizeof(uint) + 4 * sizeof(long),
+    kBufSize = 1 << 16};
+
+   static const char kMagic[8];
+
+   // Record to 'fileName', replacing any file there.
+   SearchTrace(const std::string &fileName);
+   ~SearchTrace();
+
+   bool IsOpen() const {return mOut.is_open();}
+
+   // Mark the start of a search of 'brd' to 'level'.
+   void BeginSearch(const Board *brd, int level);
+
+   void Record(int ply, int level, const Board::Move *mv, long min, long max,
+    long value, long numBoards);
+
+   void Flush();
+
+   // Read the next entry from 'is', which must be past the header.  Return
+   // false at the end of the file.
+   static bool Read(std::istream &is, Entry *entry);
+
+   // Read a file's header, returning the board class name, or "" if 'is'
+   // does not start with a trace header.
+   static std::string ReadHeader(std::istream &is);
+
+protected:
+   void Write(const Entry &entry);
+
+   std::ofstream mOut;
+   std::vector<char> mBuf;
+   bool mStarted;                // Whether the header is written
+};
+
+#endif
@@ -1,12 +1,13 @@
 #include <fstream>
 #include <assert.h>
 #include "SimpleAIPlayer.h"
-#include "Book.h"
+#include "EndgameSolver.h"
+#include "MinimaxEngine.h"
 
 using namespace std;
 
 // Preconditions: 
-// bestMove points to a BestMove object, which may have NULL for its current 
+// bestMove points to a BestMove object, which may have kNoCode for its current
 // move.  Any 'bestMove->value' V such that V <= min or V >= max is 
 // "uninteresting" to the caller.  
 // 
@@ -25,11 +26,11 @@ using namespace std;
 // fact was uncovered.
 // 
 // If 'board' is an endgame board, then  bestMove->value will be winVal, 0 or 
-// -winVal, and bestMove->move will be NULL since there is no move from an 
+// -winVal, and bestMove->move will be kNoCode since there is no move from an 
 // endgame position.  Otherwise, bestMove->move will provide the best move.  
 //
 // 'bestMove->bestReply' gives the best answering move to bestMove->move, or 
-// NULL if bestMove->move ends the game.  
+// kNoCode if bestMove->move ends the game.  Both are Move::GetCode codes.
 // 
 // 'bestMove->numBoards' gives the number of boards examined during the minimax 
 // computation, including the root board. 
@@ -45,122 +46,52 @@ using namespace std;
 
 void SimpleAIPlayer::Minimax(Board *board, int minimaxLevel, long min, long max,
  BestMove *bMove, Book *tTable, int dbg) {
-   list<Board::Move *> moves;
-   list<Board::Move *>::iterator mIter;
-   BestMove subBestMove(NULL, NULL, 0, minimaxLevel, 1);
-   const Board::Key *key = 0;
-   Book::iterator bIter;
-   pair<Book::iterator, bool> ins;
-
-   // [Staley] Level 0 computations arent worth it since a call of GetValue is 
-   // [Staley] usually quicker than a tTable lookup.
-   // [Me] So, ensure that MakeBook doesn't call this method with 
-   // minimaxLevel == 0.
-   assert(minimaxLevel >= 1);
-
-   // Before we begin "exploring" this node, first consult the transposition 
-   // table to see if we already have a precomputed best move for its
-   // board configuration [Filled blank] "with minimaxLevel at least as deep 
-   // as the one you need."
-   if (tTable && (bIter = tTable->find(key = board->GetKey())) != tTable->end()
-    && (*bIter).second.depth >= minimaxLevel) {
-      // [Filled blank] If we find the bestMove in the transposition table,
-      // then set the bestMove straightaway.
-      *bMove = (*bIter).second;
-      bMove->numBoards = 1;
-   }
-   else {
-      // To begin "exploring" this node, first figure out what the list of
-      // possible moves is, so that you can construct the nodes at the 
-      // minimaxLevel below you (one node created per Move).
-      board->GetAllMoves(&moves);
-
-      // Fill up bestMove -- assume that the bestMove for this node is an empty 
-      // BestMove.
-      *bMove = subBestMove;
-
-      // Edge case: If this node is an end-game node, then set this bestMove's 
-      // value to be the appropriate kWinVal.
-      // [Filled blank] Otherwise, bestMove->value should just be the current
-      // value of the board.
-      bMove->value = moves.size() == 0 ? board->GetValue() :
-       (board->GetWhoseMove() ? Board::kWinVal - 1 : -Board::kWinVal + 1);
-
-      // Iterate through each of the possible moves, [Filled blank] provided
-      // that the limits for this node haven't collided yet.
-      for (mIter = moves.begin(); min < max && mIter != moves.end(); mIter++) {
-
-         board->ApplyMove(*mIter);
-
-         // Base case.  If the minimax recursion can't possibly go down another
-         // level because you're at your target Level, then stop recursing down.
-         if (minimaxLevel == 1)
-            subBestMove.value = board->GetValue();
-         else
-            Minimax(board, minimaxLevel-1, min, max, &subBestMove, tTable, dbg);
-
-         // [Filled blank] Conditional: White pulls the floor up.
-         if (board->GetWhoseMove() == 1 && subBestMove.value > min) {
-            bMove->value = min = subBestMove.value;
-            
-            // [Filled blank] Set the best move to be this move.
-            bMove->SetBestMove((*mIter)->Clone());
-
-            // [Filled blank] Set the reply move to be the subBestMove,
-            // and nil out subBestMove's move.
-            bMove->SetReplyMove(subBestMove.move);
-            subBestMove.move = NULL;
-         }
-         // [Filled blank] Conditional: Black pushes the ceiling down.
-         else if (board->GetWhoseMove() == 0 && subBestMove.value < max) {
-            bMove->value = max = subBestMove.value;
-
-            // [Filled blank] Set the reply move to be the subBestMove
-            bMove->SetBestMove((*mIter)->Clone());
-
-            // [Filled blank] Set the reply move to be the subBestMove,
-            // and nil out subBestMove's move.
-            bMove->SetReplyMove(subBestMove.move);
-            subBestMove.move = NULL;
-         }
-
-         if (dbg > 0) {
-            for (int cnt = minimaxLevel-1; cnt > 0; cnt--)
-               cout << "   ";
-            cout << "Move " << (string)**mIter << " nets " << subBestMove.value
-             << " min/max is " << min << "/" << max << endl;
-         }
+   Minimax(board, minimaxLevel, min, max, bMove, tTable, NULL, Options(), dbg);
+}
 
-         board->UndoLastMove();
-         bMove->numBoards += subBestMove.numBoards;
+// If 'pv' is non-NULL, then on return it holds the principal variation, which
+// starts with bestMove->move and bestMove->replyMove and runs until the search 
+// reached its horizon, an endgame board, or a transposition table hit.  A 
+// board handed to an EndgameSolver (see Options) gives just the move and reply.
+bool SimpleAIPlayer::Minimax(Board *board, int minimaxLevel, long min, long max,
+ BestMove *bMove, Book *tTable, PVLine *pv, const Options &opts, int dbg) {
+   PHASE_TIMER(kSearch);
+   const EndgameSolver *solver = opts.endgameLimit > 0 ?
+    EndgameSolver::ForBoard(board) : NULL;
+   MinimaxEngine::Context *ctx;
+   bool finished;
+   int ndx;
+
+   if (solver && solver->GetRemaining(board) <= opts.endgameLimit) {
+      solver->Solve(board, bMove);
+      if (pv) {
+         pv->Clear();
+         if (bMove->HasMove())
+            pv->Append(bMove->move);
+         if (bMove->HasReply())
+            pv->Append(bMove->replyMove);
       }
+      return true;
+   }
 
-      // [Filled blank] Delete Move pointers contained in any unused nodes.
-      for (; mIter != moves.end(); mIter++)
-         delete *mIter;
-
-      // [Filled blank] From the loop before, a min/max limits collision doesn't
-      // return, but breaks instead (to provide time to clean up the 
-      // GetAllMoves() call.  Thus, you have to ensure that the tTable isn't
-      // added if you had a min/max collision.
-      if (tTable && minimaxLevel >= SAVE_LEVEL && min < max && bMove->move) {
-         // [Filled blank] Insert the key->bestMove mapping into the map.
-         ins = tTable->insert(pair<const Board::Key *, BestMove>(key, *bMove));
-         
-         // If you successfully inserted the key, then nil out the pointer to
-         // it before you accidentally delete it after this else{} finishes.
-         if (ins.second)
-            key = 0;
-         // [Filled blank] "And, very importantly, we update the table 
-         // even if it already has a key for the board youre computing, if 
-         // your new computation is for a deeper lookahead minimaxLevel than 
-         // the one in the tTable."
-         else if ((*ins.first).second.depth < minimaxLevel) {
-            (*ins.first).second = *bMove;
-         } 
-      }
+   ctx = new MinimaxEngine::Context(tTable, opts, pv != NULL,
+    pv && pv->length ? pv : NULL, dbg);
+   if (opts.probeEndgames)
+      ctx->solver = solver ? solver : EndgameSolver::ForBoard(board);
+   if (opts.trace)
+      opts.trace->BeginSearch(board, minimaxLevel);
+
+   MinimaxEngine::ForBoard(board)->Search(ctx, board, minimaxLevel, min, max,
+    bMove);
+   if (opts.stats)
+      *opts.stats += ctx->stats;
+   finished = !ctx->stopped;
+
+   if (pv) {
+      pv->Clear();
+      for (ndx = 0; ndx < ctx->pvLength[0]; ndx++)
+         pv->Append(ctx->pvTable[0][ndx]);
    }
-   delete key;
+   delete ctx;
+   return finished;
 }
-
-
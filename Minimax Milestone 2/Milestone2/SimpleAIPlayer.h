@@ -5,14 +5,63 @@
 #include "limits.h"
 
 class Book;
+class CancelToken;
+struct SearchStats;
+class SearchTrace;
 
 class SimpleAIPlayer {
 public:
    // Deepest allowed minimax level
    enum {SAVE_LEVEL = 1};
 
+   // Optional search behavior.  The defaults give the plain fixed-depth 
+   // search that MakeBook uses.
+   struct Options {
+      // Rather than evaluating leaf boards directly, keep searching their
+      // capture moves (see Board::GetCaptureMoves) until the board is quiet,
+      // or until quiesceDepth further halfmoves.
+      bool quiesce;
+      int quiesceDepth;
+
+      // If the board's class has an EndgameSolver, and the board is within 
+      // endgameLimit of the end of its game as the solver measures it, solve
+      // the board exactly with the solver instead.  0 turns this off.
+      int endgameLimit;
+
+      // Ask the board's EndgameSolver, if any, for the exact value of each
+      // board below the root (see EndgameSolver::Probe), and use that value
+      // instead of searching or evaluating the board whenever it has one.
+      bool probeEndgames;
+
+      // If non-NULL, stop as soon as *cancel is cancelled.  The search then
+      // unwinds without storing anything more in the Book, and its result
+      // is only the best root move found so far: res->move is kNoCode if none
+      // was searched, and res->value is not to be trusted.
+      const CancelToken *cancel;
+
+      // If non-NULL, add the search's counts (see SearchStats) to *stats.
+      // A board handed whole to an EndgameSolver adds nothing.
+      SearchStats *stats;
+
+      // If non-NULL, record each move searched into *trace (see
+      // SearchTrace), much as debugLvl > 0 writes it to cout.
+      SearchTrace *trace;
+
+      Options() : quiesce(false), quiesceDepth(8), endgameLimit(0),
+       probeEndgames(false), cancel(NULL), stats(NULL), trace(NULL) {}
+   };
+
    static void Minimax(Board *brd, int lvl, long min, long max, BestMove *res,
     Book *bk, int debugLvl = 0);
+
+   // As above, and also return in *pv the full principal variation found, if
+   // pv is non-NULL.  If *pv holds a line on entry (e.g. from a shallower 
+   // search of the same board), its moves are searched first wherever the 
+   // search follows it.  Return false if opts.cancel cut the search short,
+   // and true if it finished, even if opts.cancel was cancelled after the
+   // search made its last check.
+   static bool Minimax(Board *brd, int lvl, long min, long max, BestMove *res,
+    Book *bk, PVLine *pv, const Options &opts = Options(), int debugLvl = 0);
 };
 
-#endif
\ No newline at end of file
+#endif
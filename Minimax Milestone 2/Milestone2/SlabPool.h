@@ -0,0 +1,201 @@
+#ifndef SLABPOOL_H
+#define SLABPOOL_H
+
+#include <stdint.h>
+#include <cstdlib>
+#include <mutex>
+#include "MemStats.h"
+
+// A pool of T-sized pieces of memory, for a class's operator new and delete.
+// Each thread keeps a cache of free pieces, so that most allocations and
+// frees take no lock.  A cache that runs dry is refilled, and one that grows
+// past kHighWater is drained, kBatch pieces at a time, from and to a shared
+// depot of slabs: kSlabBytes blocks, each with a free list of its own.  A
+// slab whose pieces are all free again goes back to the system, beyond
+// kSpareSlabs kept to absorb the next burst.  So the memory held follows
+// the number of live objects down as well as up, rather than staying at its
+// peak.  A thread's cache goes back to the depot when the thread ends.
+template <class T>
+class SlabPool {
+public:
+   static void *Alloc() {
+      Cache &cache = mCache;
+      Link *rtn;
+
+      if (!cache.free)
+         Refill(&cache);
+      rtn = cache.free;
+      cache.free = rtn->next;
+      cache.count--;
+      return rtn;
+   }
+
+   static void Free(void *p) {
+      Cache &cache = mCache;
+      Link *link = (Link *)p;
+
+      link->next = cache.free;
+      cache.free = link;
+      if (++cache.count > kHighWater)
+         Release(&cache, kBatch);
+   }
+
+   // Bytes now held from the system.
+   static long GetReserved() {
+      std::lock_guard<std::mutex> lock(mLock);
+
+      return mNumSlabs * (long)kSlabBytes;
+   }
+
+protected:
+   enum {kSlabBytes = 1 << 16, kBatch = 64, kHighWater = 2 * kBatch,
+    kSpareSlabs = 1};
+
+   struct Link {Link *next;};
+
+   // Header at the start of each slab, which is aligned on kSlabBytes, so
+   // that a piece's slab is found by masking its address.
+   struct Slab {
+      Slab *next, *prev;        // Neighbors among slabs with free pieces
+      Link *free;
+      int numFree;
+   };
+
+   struct Cache {
+      Link *free;
+      int count;
+
+      Cache() : free(NULL), count(0) {}
+      ~Cache() {Release(this, count);}
+   };
+
+   enum {kHeader = (sizeof(Slab) + 15) & ~15,
+    kPerSlab = (kSlabBytes - kHeader) / sizeof(T)};
+
+   static Slab *SlabOf(Link *link)
+    {return (Slab *)((uintptr_t)link & ~(uintptr_t)(kSlabBytes - 1));}
+
+   static void Refill(Cache *cache);
+   static void Release(Cache *cache, int count);
+   static Slab *NewSlab();
+   static void Unlink(Slab *slab);
+
+   static std::mutex mLock;          // Guards all but mCache
+   static Slab *mPartial;            // Slabs with free pieces
+   static int mNumEmpty;             // Slabs with all pieces free
+   static long mNumSlabs;
+   static thread_local Cache mCache;
+};
+
+template <class T>
+std::mutex SlabPool<T>::mLock;
+
+template <class T>
+typename SlabPool<T>::Slab *SlabPool<T>::mPartial;
+
+template <class T>
+int SlabPool<T>::mNumEmpty;
+
+template <class T>
+long SlabPool<T>::mNumSlabs;
+
+template <class T>
+thread_local typename SlabPool<T>::Cache SlabPool<T>::mCache;
+
+// Move kBatch pieces into the cache, from the first slab with any free, or
+// from a new one.
+template <class T>
+void SlabPool<T>::Refill(Cache *cache) {
+   std::lock_guard<std::mutex> lock(mLock);
+   Slab *slab;
+   Link *link;
+
+   while (cache->count < kBatch) {
+      if (!mPartial) {
+         mPartial = NewSlab();
+         mNumEmpty++;
+      }
+      slab = mPartial;
+      if (slab->numFree == kPerSlab)
+         mNumEmpty--;
+
+      for (; slab->free && cache->count < kBatch; cache->count++) {
+         link = slab->free;
+         slab->free = link->next;
+         slab->numFree--;
+         link->next = cache->free;
+         cache->free = link;
+      }
+      if (!slab->free)
+         Unlink(slab);
+   }
+}
+
+// Return 'count' pieces from the cache to their slabs, and any slab thus
+// emptied beyond kSpareSlabs to the system.
+template <class T>
+void SlabPool<T>::Release(Cache *cache, int count) {
+   std::lock_guard<std::mutex> lock(mLock);
+   Slab *slab;
+   Link *link;
+
+   for (; count > 0; count--, cache->count--) {
+      link = cache->free;
+      cache->free = link->next;
+      slab = SlabOf(link);
+
+      if (!slab->free) {
+         slab->prev = NULL;
+         slab->next = mPartial;
+         if (mPartial)
+            mPartial->prev = slab;
+         mPartial = slab;
+      }
+      link->next = slab->free;
+      slab->free = link;
+
+      if (++slab->numFree == kPerSlab) {
+         if (mNumEmpty < kSpareSlabs)
+            mNumEmpty++;
+         else {
+            Unlink(slab);
+            std::free(slab);
+            mNumSlabs--;
+            MemStats::Free(MemStats::kSlab, kSlabBytes);
+         }
+      }
+   }
+}
+
+template <class T>
+typename SlabPool<T>::Slab *SlabPool<T>::NewSlab() {
+   Slab *slab = (Slab *)std::aligned_alloc(kSlabBytes, kSlabBytes);
+   char *piece = (char *)slab + kHeader;
+   Link *link;
+   int ndx;
+
+   slab->next = slab->prev = NULL;
+   slab->free = NULL;
+   for (ndx = 0; ndx < kPerSlab; ndx++, piece += sizeof(T)) {
+      link = (Link *)piece;
+      link->next = slab->free;
+      slab->free = link;
+   }
+   slab->numFree = kPerSlab;
+   mNumSlabs++;
+   MemStats::Alloc(MemStats::kSlab, kSlabBytes);
+   return slab;
+}
+
+template <class T>
+void SlabPool<T>::Unlink(Slab *slab) {
+   if (slab->prev)
+      slab->prev->next = slab->next;
+   else
+      mPartial = slab->next;
+   if (slab->next)
+      slab->next->prev = slab->prev;
+   slab->next = slab->prev = NULL;
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef THREADSHARDS_H
+#define THREADSHARDS_H
+
+#include <mutex>
+
+// A Shard of counts per thread, for statistics that every thread adds to
+// but that are read only now and then, as MemStats and PhaseTimer are.  A
+// thread counts into its own Shard, from Local, so a count is a few
+// unlocked adds to memory no other thread writes.  ForEach visits each
+// live thread's Shard, plus one holding the counts of threads since ended.
+// As a thread ends, its Shard is folded into that one and unlinked.  A
+// Shard counted into during its own thread's cleanup, after that, is not
+// linked in again, and those counts are lost.
+//
+// Shard must be all zeros when default-initialized, like the thread_local
+// it lives in, so as to count from static initialization onward.  For
+// counts that other threads read it should use std::atomic members, and
+// it must provide Add(const Shard &src), adding src's counts to its own.
+template <class Shard>
+class ThreadShards {
+public:
+   // The calling thread's Shard, linked in on first use.
+   static Shard &Local() {
+      Node &node = mLocal;
+
+      if (!node.registered)
+         Register(&node);
+      return node;
+   }
+
+   // Call fn(const Shard &) for the ended threads' Shard and for each live
+   // thread's, under a lock that keeps threads from coming or going.
+   template <class Fn>
+   static void ForEach(Fn fn) {
+      std::lock_guard<std::mutex> lock(mLock);
+      const Node *node;
+
+      fn(mRetired);
+      for (node = mHead; node; node = node->next)
+         fn(*node);
+   }
+
+private:
+   struct Node : Shard {
+      bool registered, retired;
+      Node *next;                    // Next registered Node
+   };
+
+   static void Register(Node *node);
+   static void Retire(Node *node);
+
+   static std::mutex mLock;          // Guards all but mLocal
+   static Shard mRetired;            // Sum of the Shards of ended threads
+   static Node *mHead;               // Registered Nodes
+   static thread_local Node mLocal;
+};
+
+template <class Shard>
+std::mutex ThreadShards<Shard>::mLock;
+
+template <class Shard>
+Shard ThreadShards<Shard>::mRetired;
+
+template <class Shard>
+typename ThreadShards<Shard>::Node *ThreadShards<Shard>::mHead;
+
+template <class Shard>
+thread_local typename ThreadShards<Shard>::Node ThreadShards<Shard>::mLocal;
+
+// Link the calling thread's Node into the list, and arrange for it to be
+// retired when the thread ends, unless it was retired already by a count
+// made during the thread's own cleanup.
+template <class Shard>
+void ThreadShards<Shard>::Register(Node *node) {
+   struct Retirer {
+      Node *node;
+
+      ~Retirer() {Retire(node);}
+   };
+   std::lock_guard<std::mutex> lock(mLock);
+
+   node->registered = true;
+   if (node->retired)
+      return;
+
+   static thread_local Retirer retirer;
+   retirer.node = node;
+   node->next = mHead;
+   mHead = node;
+}
+
+// Fold a Node's counts into mRetired, and unlink it.
+template <class Shard>
+void ThreadShards<Shard>::Retire(Node *node) {
+   std::lock_guard<std::mutex> lock(mLock);
+   Node **link;
+
+   mRetired.Add(*node);
+   for (link = &mHead; *link != node; link = &(*link)->next)
+      ;
+   *link = node->next;
+   node->retired = true;
+}
+
+#endif
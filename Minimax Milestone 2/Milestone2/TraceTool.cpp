@@ -0,0 +1,144 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <climits>
+#include <vector>
+#include "Class.h"
+#include "Board.h"
+#include "SearchTrace.h"
+
+using namespace std;
+
+// Counts over all entries at one ply.
+struct PlyCounts {
+   long entries;
+   long numBoards;
+
+   PlyCounts() : entries(0), numBoards(0) {}
+};
+
+// Return the text of the move whose code is 'code', using *mv to decode it.
+static string MoveText(Board::Move *mv, uint code) {
+   try {
+      mv->SetCode(code);
+      return (string)*mv;
+   }
+   catch (BaseException &exc) {
+      return FString("?%08x", code);
+   }
+}
+
+// Write one line per search, giving its level, entries and the boards
+// examined below its root moves, and then the entries and boards at each
+// ply over all searches.
+static void Summarize(istream &in) {
+   vector<PlyCounts> plies;
+   SearchTrace::Entry entry;
+   long searches = 0, entries = 0, numBoards = 0;
+   int level = 0, ply;
+
+   while (SearchTrace::Read(in, &entry)) {
+      if (entry.level < 0) {
+         if (searches)
+            cout << FString("Search %ld level %d entries %ld boards %ld",
+             searches, level, entries, numBoards) << endl;
+         searches++;
+         level = entry.move;
+         entries = numBoards = 0;
+         continue;
+      }
+      if (entry.ply < 0)
+         continue;
+      if (entry.ply >= (int)plies.size())
+         plies.resize(entry.ply + 1);
+      plies[entry.ply].entries++;
+      plies[entry.ply].numBoards += entry.numBoards;
+      entries++;
+      if (entry.ply == 0)
+         numBoards += entry.numBoards;
+   }
+   if (searches)
+      cout << FString("Search %ld level %d entries %ld boards %ld",
+       searches, level, entries, numBoards) << endl;
+
+   for (ply = 0; ply < (int)plies.size(); ply++)
+      cout << FString("Ply %2d entries %10ld boards %12ld", ply,
+       plies[ply].entries, plies[ply].numBoards) << endl;
+}
+
+// Write the entries from ply minPly through maxPly, and only those of
+// moveText if it isn't empty, as a search with debugLvl > 0 would.  Entries
+// come in the order the search finished them, so each move follows the
+// moves searched below it.  Lines are indented by ply rather than level.
+static void Print(istream &in, Board::Move *mv, int minPly, int maxPly,
+ const string &moveText) {
+   SearchTrace::Entry entry;
+   string text;
+   long searches = 0;
+   int cnt;
+
+   while (SearchTrace::Read(in, &entry)) {
+      if (entry.level < 0) {
+         cout << "Search " << ++searches << " level " << entry.move << endl;
+         continue;
+      }
+      if (entry.ply < minPly || entry.ply > maxPly)
+         continue;
+
+      text = MoveText(mv, entry.move);
+      if (!moveText.empty() && text != moveText)
+         continue;
+      for (cnt = entry.ply; cnt > 0; cnt--)
+         cout << "   ";
+      cout << "Move " << text << " nets " << entry.value << " min/max is "
+       << entry.min << "/" << entry.max << " boards " << entry.numBoards
+       << endl;
+   }
+}
+
+// Read a file written by SearchTrace.  Usage:
+//
+// TraceTool traceFile [summary | print [minPly [maxPly [moveText]]]]
+//
+// "summary", the default, gives per-search and per-ply counts.  "print"
+// renders the entries, optionally only those between minPly and maxPly
+// inclusive, and of them only the moves whose text is moveText.
+int main(int argc, char **argv) {
+   string cmd = argc > 2 ? argv[2] : "summary", name;
+   int minPly = argc > 3 ? atoi(argv[3]) : 0;
+   int maxPly = argc > 4 ? atoi(argv[4]) : INT_MAX;
+   const BoardClass *boardClass;
+   Board *brd;
+   Board::Move *mv;
+   ifstream in;
+
+   if (argc < 2 || argc > 6 || (cmd != "summary" && cmd != "print")
+    || (cmd == "summary" && argc > 3)) {
+      cout << "Usage: TraceTool traceFile [summary | print [minPly [maxPly "
+       "[moveText]]]]" << endl;
+      return -1;
+   }
+
+   in.open(argv[1], ios::binary);
+   if (!in) {
+      cout << "Can't open " << argv[1] << endl;
+      return -1;
+   }
+   name = SearchTrace::ReadHeader(in);
+   if (name.empty() || !(boardClass =
+    dynamic_cast<const BoardClass *>(BoardClass::ForName(name)))) {
+      cout << argv[1] << " is not a trace of a known board class" << endl;
+      return -1;
+   }
+
+   if (cmd == "summary")
+      Summarize(in);
+   else {
+      brd = dynamic_cast<Board *>(boardClass->NewInstance());
+      mv = brd->CreateMove();
+      Print(in, mv, minPly, maxPly, argc > 5 ? argv[5] : "");
+      delete mv;
+      delete brd;
+   }
+   return 0;
+}
@@ -7,6 +7,7 @@
 
 class View : public Object {
 public:
+   virtual ~View() {}
    virtual void Draw(std::ostream &out) = 0;
    virtual void SetModel(const Board *brd) {mModel = brd;}
 